@@ -3,67 +3,138 @@
 #include <stdio.h>		// printf
 #include <exception>	// std::exception
 
-GameTag Bitboard::FindWinner()
+/*
+Bit permutations of the 8 symmetries (see Bitboard.h), precomputed per byte.
+A board is transformed by looking up each of its bytes and joining the results.
+*/
+struct SymmetryTables
 {
-	int index = 0;
-	U16 currPat;
+	U16 bytes[8][2][256];
 
-	/* Loop through all 10 possible win patterns (defined in winPatterns) */
-	while (index < 10)		
+	SymmetryTables()
 	{
-		currPat = winPatterns[index++];
-
-		/* 
-		Check if the board of the player contains the current pattern.
-		example:
-			xBoard   ==  0100 1111 0001 1010
-		&	pattern  ==	 0000 1111 0000 0000
-			--------------------------------
-						 0000 1111 0000 0000 == pattern ==> x wins
-		*/
-
-		if ((xBoard & currPat) == currPat)
-			return GameTag::Player_X;
-		if ((oBoard & currPat) == currPat)
-			return GameTag::Player_O;
+		for (int transform = 0; transform < 8; transform++)
+		{
+			// Find where each bit moves to, using the index mapping (index = 15 - bit)
+			int target[16];
+			for (int bit = 0; bit < 16; bit++)
+			{
+				int row = (15 - bit) / 4;
+				int col = (15 - bit) % 4;
+
+				if (transform & 4)		// Mirror
+					col = 3 - col;
+
+				for (int turn = 0; turn < (transform & 3); turn++)
+				{
+					int newRow = col;	// Clockwise quarter turn: (row, col) ==> (col, 3 - row)
+					col = 3 - row;
+					row = newRow;
+				}
+				target[bit] = 15 - (row * 4 + col);
+			}
+
+			for (int half = 0; half < 2; half++)
+				for (int byte = 0; byte < 256; byte++)
+				{
+					U16 result = 0;
+					for (int bit = 0; bit < 8; bit++)
+						if (byte & (1 << bit))
+							result |= 1 << target[half * 8 + bit];
+					bytes[transform][half][byte] = result;
+				}
+		}
 	}
+};
 
-	/*
-	(xBoard | oBoard) yields the complete board (both players). 
-	If it's equal to UINT16_MAX then it is full (all bits set), 
-	and since we didn't return a winner it must be a draw.
-	*/
-	if ((xBoard | oBoard) == UINT16_MAX)
-		return GameTag::Result_Draw;
-
-	// If every check fails it's still mid-game 
-	return GameTag::Result_None;		
-}
+static const SymmetryTables symmetry;
 
-GameTag Bitboard::GetOtherPlayerTag() const
+/*
+One bit for every possible 16-bit board of a single player, set if the board contains a win pattern.
+The table takes 8KB and replaces the loop over winPatterns with a single lookup.
+*/
+struct WinTable
 {
-	return (m_Player == GameTag::Player_X) ? GameTag::Player_O : GameTag::Player_X;
-}
+	U64 bits[65536 / 64];
 
-U16 *Bitboard::GetAvailableMoves() const
+	WinTable()
+	{
+		for (int board = 0; board < 65536; board++)
+		{
+			bits[board >> 6] &= ~((U64)1 << (board & 63));
+
+			/* Loop through all 10 possible win patterns (defined in winPatterns) */
+			for (int index = 0; index < 10; index++)
+			{
+				/* 
+				Check if the board contains the current pattern.
+				example:
+					board    ==  0100 1111 0001 1010
+				&	pattern  ==	 0000 1111 0000 0000
+					--------------------------------
+								 0000 1111 0000 0000 == pattern ==> win
+				*/
+				if ((board & winPatterns[index]) == winPatterns[index])
+					bits[board >> 6] |= (U64)1 << (board & 63);
+			}
+		}
+	}
+};
+
+static const WinTable winTable;
+
+/*
+The length of a chain on a single win pattern, indexed by the squares of the player (low nibble)
+and of the other player (high nibble) on that pattern. Patterns the other player blocked have no chain.
+*/
+struct ChainTable
 {
-	// Get all set bits on the board, then flip to get all clear bits
-	U16 board = ~(xBoard | oBoard);
+	U8 chains[256];
+
+	ChainTable()
+	{
+		for (int index = 0; index < 256; index++)
+			chains[index] = (index >> 4) ? 0 : (U8)CountBitsU16((U16)(index & 0xF));
+	}
+};
+
+static const ChainTable chainTable;
 
-	// Least significant bit
-	U16 ls1b;
+/*
+Gathers the 4 squares of each win pattern of a board into a nibble, 10 nibbles in all.
+Rows are already nibbles. Columns and diagonals are packed by a multiplication that moves
+each of their squares to a different bit of the top nibble, without carries:
 
-	int moveNumber = 0;
+	column:		((board >> c) & 0x1111) * 0x1248, squares 0 4 8 12 land on bits 12 13 14 15
+	diagonal \:	(board & 0x8421) * 0x1111
+	diagonal /:	(board & 0x1248) * 0x1111
+
+The order of the squares inside a nibble doesn't matter, both boards are gathered the same way.
+*/
+static inline U64 GatherLines(U16 board)
+{
+	U32 b = board;
+	return (U64)b											// Rows 1-4
+		| (U64)((((b >> 3) & 0x1111) * 0x1248) >> 12 & 0xF) << 16	// Columns 1-4
+		| (U64)((((b >> 2) & 0x1111) * 0x1248) >> 12 & 0xF) << 20
+		| (U64)((((b >> 1) & 0x1111) * 0x1248) >> 12 & 0xF) << 24
+		| (U64)((((b	 ) & 0x1111) * 0x1248) >> 12 & 0xF) << 28
+		| (U64)(((b & 0x8421) * 0x1111) >> 12 & 0xF) << 32		// Diagonals \ and /
+		| (U64)(((b & 0x1248) * 0x1111) >> 12 & 0xF) << 36;
+}
 
-	U16 *moves = new U16[m_BitCount]();
+bool Bitboard::HasWinPattern(U16 board)
+{
+	return ((winTable.bits[board >> 6] >> (board & 63)) & 1) != 0;
+}
 
+void Bitboard::GetAvailableMoves(MoveList &moves) const
+{
+	U16 board = GetAvailableMovesMask();
+
+	moves.count = 0;
 	while (board)
-	{
-		ls1b = board & -board;			// Isolate the least-significant bit
-		moves[moveNumber++] = ls1b;		// Add move to array
-		board ^= ls1b;					// Clear ls1b from the board
-	}
-	return moves;
+		moves.moves[moves.count++] = PopMove(board);
 }
 
 bool Bitboard::CheckMove(U16 move)
@@ -76,7 +147,7 @@ bool Bitboard::CheckMove(U16 move)
 Bitboard Bitboard::DoMove(U16 move, GameTag player)
 {
 	// This prevents problems with game logic
-	if (player != m_Player)
+	if (player != GetPlayerTag())
 		throw std::exception("The given player is not next to make a move");
 	
 	return DoMove(move);
@@ -87,67 +158,70 @@ Bitboard Bitboard::DoMove(U16 move)
 	if ((xBoard | oBoard) & move)	// The requested move isn't empty
 		throw std::exception("Invalid move");
 
-	if (m_Player == GameTag::Player_X) return Bitboard(xBoard | move, oBoard, GameTag::Player_O);
-	else				   			   return Bitboard(xBoard, oBoard | move, GameTag::Player_X);
+	return DoMoveUnchecked(move);
 }
 
-int Bitboard::CountClearBits()
+Bitboard Bitboard::DoMoveUnchecked(U16 move) const
 {
-	int count = 0;
-	/* Same method as CountBitsU16 */
-	U16 ls1b;
-	U16 x = ~(xBoard | oBoard);		// Get the full board and invert bits
-	while (x)
-	{
-		ls1b = x & -x;
-		++count;
-		x ^= ls1b;
-	}
-	return count;
+	GameTag player = GetPlayerTag();
+	U16 newX = xBoard, newO = oBoard;
+	if (player == GameTag::Player_X) newX |= move;
+	else							 newO |= move;
+
+	/*
+	Only the player who moved can have completed a win pattern (see WinTable),
+	the game would have ended on an earlier move otherwise.
+	If the board is full (all bits set) and nobody won, it's a draw.
+	*/
+	GameTag winner = GameTag::Result_None;
+	if (HasWinPattern((player == GameTag::Player_X) ? newX : newO))
+		winner = player;
+	else if ((U16)(newX | newO) == UINT16_MAX)
+		winner = GameTag::Result_Draw;
+
+	return Bitboard(newX, newO, (player == GameTag::Player_X) ? GameTag::Player_O : GameTag::Player_X, winner);
 }
 
-/* Counts the number of set bits in a given number */
-int CountBitsU16(U16 x)
+U16 Bitboard::GetWinningSquares(GameTag player) const
 {
-	int count = 0;
-	// Least significant bit
-	U16 ls1b;
-	
-	// while x>0
-	while (x)
+	U16 board = (player == GameTag::Player_X) ? xBoard : oBoard;
+	U16 clear = GetAvailableMovesMask();
+
+	/*
+	A pattern is one move away from a win if exactly one of its squares is missing from the board,
+	i.e. the missing squares are a single bit (missing & (missing - 1) clears it), and that square is clear.
+	*/
+	U16 squares = 0;
+	for (int index = 0; index < 10; index++)
 	{
-		ls1b = x & -x;	// Isolate ls1b
-		++count;		
-		x ^= ls1b;		// Renove ls1b from board
+		U16 missing = winPatterns[index] & ~board;
+		if ((missing & (missing - 1)) == 0)
+			squares |= missing & clear;
 	}
-	return count;
+	return squares;
 }
 
-int Bitboard::ChainScoreForPlayer(GameTag player)
+int Bitboard::ChainScoreForPlayer(GameTag player) const
 {
-	int chainScore = 0;
-	int longestChain = 0;
-	int currChain = 0;
-	int index = 0;
-	U16 currPat;
-
 	U16 board = xBoard;			// Use the player's board to count score for moves
 	U16 otherBoard = oBoard;	// Use the other board to exclude moves the other player blocked
 
 	// Set the boards according to the player
 	if (player == GameTag::Player_O) { board = oBoard; otherBoard = xBoard; }
 
-	// Loop through all win patterns
-	while (index < 10)
+	U64 lines = GatherLines(board);
+	U64 otherLines = GatherLines(otherBoard);
+
+	int chainScore = 0;
+	int longestChain = 0;
+
+	// One lookup per win pattern, blocked patterns have a chain of 0 (see ChainTable)
+	for (int line = 0; line < 10; line++, lines >>= 4, otherLines >>= 4)
 	{
-		currPat = winPatterns[index++];
-		if (!(currPat & otherBoard))						// Completely ignore blocked moves
-		{
-			currChain = CountBitsU16((currPat & board));	// Get the number of squares of the chain we have
-			chainScore += currChain*currChain;				// Add the score of the chain
-			if (currChain>longestChain)						// Update longest chain
-				longestChain = currChain;	
-		}
+		int chain = chainTable.chains[(lines & 0xF) | (otherLines & 0xF) << 4];
+		chainScore += chain * chain;					// Add the score of the chain
+		if (chain > longestChain)						// Update longest chain
+			longestChain = chain;
 	}
 	return chainScore + longestChain;	// The score is the sum of all partial chains squared and the longest one
 }
@@ -192,9 +266,9 @@ void Bitboard::Print()
 	}
 
 	/* Print which player is taking the next turn */
-	if (m_Winner == GameTag::Result_None)
+	if (GetWinner() == GameTag::Result_None)
 	{
-		if (m_Player == GameTag::Player_X)
+		if (GetPlayerTag() == GameTag::Player_X)
 			printf("X's turn.\n");
 		else
 			printf("O's turn.\n");
@@ -240,4 +314,38 @@ U32 Bitboard::EncodeBoardU32(GameTag player)
 		encoded |= (U32)oBoard << 16;
 
 	return encoded;
+}
+
+U16 Bitboard::TransformBoard(U16 board, int transform)
+{
+	return symmetry.bytes[transform][0][board & 0xFF] | symmetry.bytes[transform][1][board >> 8];
+}
+
+int Bitboard::FindCanonicalTransform(U16 xB, U16 oB)
+{
+	/* The canonical board is the one with the smallest (xBoard, oBoard) pair */
+	U32 bestKey = (U32)xB << 16 | oB;
+	int bestTransform = 0;
+
+	for (int transform = 1; transform < 8; transform++)
+	{
+		U32 key = (U32)TransformBoard(xB, transform) << 16 | TransformBoard(oB, transform);
+		if (key < bestKey)
+		{
+			bestKey = key;
+			bestTransform = transform;
+		}
+	}
+	return bestTransform;
+}
+
+Bitboard Bitboard::GetCanonical(int &transform) const
+{
+	transform = FindCanonicalTransform(xBoard, oBoard);
+
+	// The winner, player and count of clear bits don't change under symmetry
+	Bitboard canonical = *this;
+	canonical.xBoard = TransformBoard(xBoard, transform);
+	canonical.oBoard = TransformBoard(oBoard, transform);
+	return canonical;
 }
\ No newline at end of file
@@ -2,10 +2,15 @@
 
 #include <vector>
 #include <stdint.h>		// For UINT16_MAX
+#if defined(_MSC_VER)
+#include <intrin.h>		// __popcnt16
+#endif
 
 // Define unsigned integers for board and move storage
+typedef uint8_t  U8;
 typedef uint16_t U16;
 typedef uint32_t U32;
+typedef uint64_t U64;
 
 enum class GameTag
 {
@@ -41,6 +46,14 @@ NOTES
 		2. & (AND)
 			detecting patterns
 			checking move legality
+
+SYMMETRIES
+
+	The board has 8 symmetries, numbered 0-7:
+		transform & 3	number of clockwise quarter turns
+		transform & 4	mirror left-right before turning
+	0 is the identity, 1-3 are rotations, 4-7 are reflections.
+	Reflections undo themselves, rotations are undone by the opposite rotation.
 */
 
 /* 
@@ -60,10 +73,33 @@ static const U16 winPatterns[10] = {
 	4680		/* Diagonal / */
 };
 
+/* Counts the number of set bits of a 16-bit board. */
+inline int CountBitsU16(U16 x)
+{
+#if defined(_MSC_VER) && defined(__AVX__)
+	return __popcnt16(x);				// Every CPU with AVX has the POPCNT instruction
+#elif defined(__GNUC__) || defined(__clang__)
+	return __builtin_popcount(x);
+#else
+	x = x - ((x >> 1) & 0x5555);
+	x = (x & 0x3333) + ((x >> 2) & 0x3333);
+	x = (x + (x >> 4)) & 0x0F0F;
+	return (x + (x >> 8)) & 0x1F;
+#endif
+}
+
+/* A fixed-capacity list of moves, filled without heap allocation. */
+struct MoveList
+{
+	U16 moves[16];
+	int count;
+};
+
 /* 
 A compact representation of tic-tac-toe boards as 16-bit unsigned ints.
 Bitboards are immutable to allow minimax search. 
 Move generation is done by returning a new board, rather than modifing the currnt one.
+A board takes 8 bytes: the two player boards and one packed state (player to move and winner).
 The class contains a few standard functions, i.e. GetAvailableMoves, DoMove etc.
 a Print function to print the board, and some useful functions for board evaluation.
 */
@@ -75,21 +111,37 @@ public:
 	Bitboard(GameTag firstPlayer=GameTag::Player_X) : 
 		xBoard(0),						// Empty board
 		oBoard(0),						// Empty board
-		m_Player(firstPlayer),			
-		m_Winner(GameTag::Result_None),	// No winner, RESULT_NONE
-		m_BitCount(16) {};		
+		m_State(PackState(firstPlayer, GameTag::Result_None)) {};		// No winner, RESULT_NONE
 
 	~Bitboard() {} ;
 
 	/* Returns the identifier of the player who is next to make a move. */
-	inline GameTag GetPlayerTag() const { return m_Player; }
+	inline GameTag GetPlayerTag() const { return (GameTag)(m_State & STATE_TAG_MASK); }
 	/* Returns the identifier of the player who is NOT next to make a move. */
-	inline GameTag GetOtherPlayerTag() const;
+	inline GameTag GetOtherPlayerTag() const { return (GetPlayerTag() == GameTag::Player_X) ? GameTag::Player_O : GameTag::Player_X; }
 	/* Returns the player who has won, or indicate a draw or a mid-game state (State_None). */
-	inline GameTag GetWinner() const { return m_Winner; }
+	inline GameTag GetWinner() const { return (GameTag)((m_State >> STATE_WINNER_SHIFT) & STATE_TAG_MASK); }
+
+	/* Returns true if the board of a single player contains one of the win patterns. */
+	static bool HasWinPattern(U16 board);
 
-	/* Returns an array of indicies of all legal moves for the currnt board. */
-	U16 *GetAvailableMoves() const;
+	/* Returns the raw bitboards of each player, used for hashing and lookup tables. */
+	inline U16 GetXBoard() const { return xBoard; }
+	inline U16 GetOBoard() const { return oBoard; }
+
+	/* Fills a move list with all legal moves, least-significant bit first. */
+	void GetAvailableMoves(MoveList &moves) const;
+
+	/* Returns all legal moves as the set bits of one mask, walk them with PopMove. */
+	inline U16 GetAvailableMovesMask() const { return (U16)~(xBoard | oBoard); }
+
+	/* Removes the least-significant move from a moves mask and returns it. */
+	static inline U16 PopMove(U16 &moves) 
+	{ 
+		U16 ls1b = moves & -moves;
+		moves ^= ls1b;
+		return ls1b;
+	}
 
 	/* Returns true if the move is legal, false otherwise. */
 	bool CheckMove(U16 move);
@@ -102,15 +154,27 @@ public:
 
 	/*
 	Returns a new board after making the specified move.
-	Does not check for errors, to be used with minimax.
+	Checks that the square is clear.
 	*/
 	Bitboard DoMove(U16 move);
 
+	/*
+	Returns a new board after making the specified move.
+	Does not check for errors, to be used with minimax on moves from GetAvailableMoves.
+	*/
+	Bitboard DoMoveUnchecked(U16 move) const;
+
 	/* Returns the number of clear bits in the board, i.e. the number of moves available. */
-	inline int GetClearBitsCount() const { return m_BitCount; }
+	inline int GetClearBitsCount() const { return CountBitsU16(GetAvailableMovesMask()); }
+
+	/* 
+	Returns the clear squares where a player would complete a win pattern, as the set bits of one mask.
+	Works for either player, not only the one to move.
+	*/
+	U16 GetWinningSquares(GameTag player) const;
 
 	/* Returns an evaluation of the board regarding a player, based on number of chains and longest one. */
-	int ChainScoreForPlayer(GameTag player);
+	int ChainScoreForPlayer(GameTag player) const;
 
 	/* Print the board to the console. */
 	void Print();
@@ -120,32 +184,44 @@ public:
 	 
 	U32 EncodeBoardU32(GameTag player);
 
+	/* 
+	Returns the canonical form of the board, the smallest of its 8 symmetric boards.
+	transform is set to the symmetry that maps this board to the canonical one.
+	*/
+	Bitboard GetCanonical(int &transform) const;
+
+	/* Returns the symmetry that maps the given boards to their canonical form. */
+	static int FindCanonicalTransform(U16 xB, U16 oB);
+
+	/* Applies one of the 8 symmetries to a board or a move, see SYMMETRIES. */
+	static U16 TransformBoard(U16 board, int transform);
+
+	/* Returns the symmetry that undoes the given one, used to map moves back to the original board. */
+	static inline int InverseTransform(int transform) { return (transform < 4) ? (4 - transform) & 3 : transform; }
+
 private:
 	
-	/* Private constructor, used in move generation. */
-	inline Bitboard(U16 xB, U16 oB, GameTag player) :
+	/* Private constructor, used in move generation. The winner is found by DoMoveUnchecked. */
+	inline Bitboard(U16 xB, U16 oB, GameTag player, GameTag winner) :
 		xBoard(xB),
 		oBoard(oB),
-		m_Player(player),
-		m_BitCount(CountClearBits()),
-		m_Winner(FindWinner()) {};
+		m_State(PackState(player, winner)) {};
+
+	/* State layout: player to move (2 bits) | winner (2 bits) */
+	static const U32 STATE_TAG_MASK = 3;
+	static const int STATE_WINNER_SHIFT = 2;
+
+	static inline U32 PackState(GameTag player, GameTag winner) { return (U32)player | (U32)winner << STATE_WINNER_SHIFT; }
 
 	/* The bitboard of the 'X' player. */
 	U16 xBoard;
 	/* The bitboard of the 'O' player. */
 	U16 oBoard;
 	
-	/* The player who is next to make a move. */
-	GameTag m_Player;
-
-	/* Number of clear bits */
-	inline int CountClearBits();
-	int m_BitCount;
-
-	/* Find the winner, used once during construction. */
-	inline GameTag FindWinner();
-	/* The identifier of the winner (x, o, draw, none). */
-	GameTag m_Winner;
+	/* The player who is next to make a move, and the identifier of the winner (x, o, draw, none). */
+	U32 m_State;
 
 };
 
+static_assert(sizeof(Bitboard) == 8, "Bitboards are expected to take 8 bytes");
+
@@ -0,0 +1,295 @@
+#pragma once
+#include "Bitboard.h"
+#include <type_traits>
+#include <utility>		// std::integer_sequence
+#include <exception>
+#include <stdio.h>
+
+/*
+BOARD REPRESENTATION (N x N, K in a row)
+
+	Bits are mapped row by row, from the top-left corner:
+
+	0      1      ...  N-1
+	N      N+1    ...  2N-1
+	...
+	N(N-1) ...         N*N-1
+
+	Boards are stored in the smallest unsigned integer that fits N*N bits (U16, U32 or U64).
+
+LINE DETECTION
+
+	A player has K in a row in direction step d (1 row, N column, N+1 diagonal \, N-1 diagonal /)
+	if some bit p is set together with p+d, p+2d ... p+(K-1)d, and the line starting at p
+	doesn't wrap around the edges of the board:
+
+		board & (board >> d) & (board >> 2d) ... & (board >> (K-1)d) & startMask(d) != 0
+
+	The start masks and the K-1 shifts are resolved at compile time for every (N, K),
+	so each size gets straight-line code with no loop over win patterns.
+	The chain score is unrolled the same way, one step per line with the mask as a constant.
+
+	This is the board engine only. The players and GameManager work on the 4x4 Bitboard: their search,
+	tables, symmetry and tablebase code depend on its 16-bit layout.
+*/
+
+/* The unsigned integer type used to store one player's board of N x N squares. */
+template<int N>
+struct BoardStorage
+{
+	typedef typename std::conditional<(N * N <= 16), U16,
+			typename std::conditional<(N * N <= 32), U32, U64>::type>::type Type;
+};
+
+/* Counts the number of set bits in a board of any size. */
+inline int CountBitsU64(U64 x)
+{
+	x = x - ((x >> 1) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (int)((x * 0x0101010101010101ULL) >> 56);
+}
+
+/* The AND of a board shifted by 0, D, 2D ... I*D squares, unrolled at compile time. */
+template<typename T, int D, int I>
+struct LineRun
+{
+	static inline T Of(T board) { return (T)(board >> (D * I)) & LineRun<T, D, I - 1>::Of(board); }
+};
+
+template<typename T, int D>
+struct LineRun<T, D, 0>
+{
+	static inline T Of(T board) { return board; }
+};
+
+/* The lines of an N x N board with K in a row, computed at compile time (C++11 constexpr). */
+template<int N, int K>
+struct BoardLinesNK
+{
+	typedef typename BoardStorage<N>::Type Board;
+
+	static const int SQUARES = N * N;
+
+	/* Number of lines: rows, columns, diagonals \ and diagonals / */
+	static const int STARTS_PER_LINE = N - K + 1;
+	static const int LINE_COUNT = 2 * N * STARTS_PER_LINE + 2 * STARTS_PER_LINE * STARTS_PER_LINE;
+
+	/* A board with every square set */
+	static constexpr Board FullBoard() { return (Board)(SQUARES == 64 ? ~0ULL : (1ULL << (SQUARES % 64)) - 1); }
+
+	/* Bits p where a line in direction (rowStep, colStep) starting at p stays on the board */
+	static constexpr Board StartMask(int rowStep, int colStep, int p = 0)
+	{
+		return (p >= SQUARES) ? (Board)0 : (Board)(
+			((p / N + rowStep * (K - 1) < N &&
+			  p % N + colStep * (K - 1) < N &&
+			  p % N + colStep * (K - 1) >= 0) ? (Board)1 << p : (Board)0) |
+			StartMask(rowStep, colStep, p + 1));
+	}
+
+	/* The K squares starting at (row, col) in direction (rowStep, colStep) */
+	static constexpr Board LineSquares(int row, int col, int rowStep, int colStep, int length = K)
+	{
+		return (length == 0) ? (Board)0 :
+			(Board)(((Board)1 << (row * N + col)) | LineSquares(row + rowStep, col + colStep, rowStep, colStep, length - 1));
+	}
+
+	/* The squares of a line, lines are numbered rows first, then columns, diagonals \ and diagonals / */
+	static constexpr Board LineMask(int line)
+	{
+		return
+			(line < N * STARTS_PER_LINE) ?
+				LineSquares(line / STARTS_PER_LINE, line % STARTS_PER_LINE, 0, 1) :
+			(line < 2 * N * STARTS_PER_LINE) ?
+				LineSquares((line - N * STARTS_PER_LINE) % STARTS_PER_LINE, (line - N * STARTS_PER_LINE) / STARTS_PER_LINE, 1, 0) :
+			(line < 2 * N * STARTS_PER_LINE + STARTS_PER_LINE * STARTS_PER_LINE) ?
+				LineSquares((line - 2 * N * STARTS_PER_LINE) / STARTS_PER_LINE, (line - 2 * N * STARTS_PER_LINE) % STARTS_PER_LINE, 1, 1) :
+				LineSquares((line - LINE_COUNT + STARTS_PER_LINE * STARTS_PER_LINE) / STARTS_PER_LINE,
+							(line - LINE_COUNT + STARTS_PER_LINE * STARTS_PER_LINE) % STARTS_PER_LINE + K - 1, 1, -1);
+	}
+};
+
+/* All line masks of a board size as a compile-time array, the N x N version of winPatterns. */
+template<int N, int K, typename Lines = std::make_integer_sequence<int, BoardLinesNK<N, K>::LINE_COUNT>>
+struct WinPatternsNK;
+
+template<int N, int K, int... Lines>
+struct WinPatternsNK<N, K, std::integer_sequence<int, Lines...>>
+{
+	static constexpr typename BoardStorage<N>::Type masks[sizeof...(Lines)] = { BoardLinesNK<N, K>::LineMask(Lines)... };
+};
+
+template<int N, int K, int... Lines>
+constexpr typename BoardStorage<N>::Type WinPatternsNK<N, K, std::integer_sequence<int, Lines...>>::masks[sizeof...(Lines)];
+
+/*
+An N x N board with K in a row to win, with the same interface as the 4x4 Bitboard.
+Bitboards are immutable, move generation returns a new board.
+*/
+template<int N, int K>
+class BitboardNK
+{
+	static_assert(N >= 3 && N <= 8, "Boards must be between 3x3 and 8x8");
+	static_assert(K >= 3 && K <= N, "Lines must be at least 3 and at most N squares long");
+
+	typedef BoardLinesNK<N, K> Lines;
+
+public:
+
+	typedef typename BoardStorage<N>::Type Board;
+
+	static const int SQUARES = N * N;
+	static const int LINE_COUNT = Lines::LINE_COUNT;
+
+	/* Bits where a line of K squares may start in each direction */
+	static constexpr Board FULL_BOARD			= Lines::FullBoard();
+	static constexpr Board ROW_STARTS			= Lines::StartMask(0, 1);
+	static constexpr Board COLUMN_STARTS		= Lines::StartMask(1, 0);
+	static constexpr Board DIAGONAL_STARTS		= Lines::StartMask(1, 1);
+	static constexpr Board ANTI_DIAGONAL_STARTS = Lines::StartMask(1, -1);
+
+	/* Default constructor for an empty board */
+	BitboardNK(GameTag firstPlayer = GameTag::Player_X) :
+		xBoard(0),
+		oBoard(0),
+		m_Player(firstPlayer),
+		m_Winner(GameTag::Result_None) {}
+
+	/* Returns the identifier of the player who is next to make a move. */
+	inline GameTag GetPlayerTag() const { return m_Player; }
+	/* Returns the identifier of the player who is NOT next to make a move. */
+	inline GameTag GetOtherPlayerTag() const { return (m_Player == GameTag::Player_X) ? GameTag::Player_O : GameTag::Player_X; }
+	/* Returns the player who has won, or indicate a draw or a mid-game state (State_None). */
+	inline GameTag GetWinner() const { return m_Winner; }
+
+	inline Board GetXBoard() const { return xBoard; }
+	inline Board GetOBoard() const { return oBoard; }
+
+	/* Returns true if the board of a single player contains K in a row, see LINE DETECTION. */
+	static inline bool HasWinPattern(Board board)
+	{
+		return (
+			(LineRun<Board, 1,	   K - 1>::Of(board) & ROW_STARTS)		|
+			(LineRun<Board, N,	   K - 1>::Of(board) & COLUMN_STARTS)	|
+			(LineRun<Board, N + 1, K - 1>::Of(board) & DIAGONAL_STARTS)	|
+			(LineRun<Board, N - 1, K - 1>::Of(board) & ANTI_DIAGONAL_STARTS)) != 0;
+	}
+
+	/* Returns all legal moves as the set bits of one mask, walk them with PopMove. */
+	inline Board GetAvailableMovesMask() const { return (Board)(~(xBoard | oBoard) & FULL_BOARD); }
+
+	/* Removes the least-significant move from a moves mask and returns it. */
+	static inline Board PopMove(Board &moves)
+	{
+		Board ls1b = moves & (Board)(0 - moves);
+		moves ^= ls1b;
+		return ls1b;
+	}
+
+	/* Returns true if the move is legal, false otherwise. */
+	inline bool CheckMove(Board move) const { return move != 0 && !((xBoard | oBoard) & move); }
+
+	/* Returns a new board after making the specified move, checks that the square is clear. */
+	BitboardNK DoMove(Board move) const
+	{
+		if (!CheckMove(move))
+			throw std::exception("Invalid move");
+		return DoMoveUnchecked(move);
+	}
+
+	/* Returns a new board after making the specified move, without checks. */
+	inline BitboardNK DoMoveUnchecked(Board move) const
+	{
+		/* Only the player who moved can have completed a line */
+		if (m_Player == GameTag::Player_X) return BitboardNK(xBoard | move, oBoard, GameTag::Player_O, HasWinPattern(xBoard | move));
+		else							   return BitboardNK(xBoard, oBoard | move, GameTag::Player_X, HasWinPattern(oBoard | move));
+	}
+
+	/* Returns the number of clear bits in the board, i.e. the number of moves available. */
+	inline int GetClearBitsCount() const { return CountBitsU64(GetAvailableMovesMask()); }
+
+	/* Returns an evaluation of the board regarding a player, based on number of chains and longest one. */
+	int ChainScoreForPlayer(GameTag player) const
+	{
+		Board board = (player == GameTag::Player_O) ? oBoard : xBoard;
+		Board otherBoard = (player == GameTag::Player_O) ? xBoard : oBoard;
+
+		int chainScore = 0;
+		int longestChain = 0;
+		AddChains(board, otherBoard, chainScore, longestChain, std::make_integer_sequence<int, LINE_COUNT>());
+		return chainScore + longestChain;
+	}
+
+	/* Print the board to the console. */
+	void Print() const
+	{
+		printf("\nBoard:\n\t ");
+		for (int col = 0; col < N; col++)
+			printf("  %i ", col + 1);
+		printf("\n\n");
+
+		for (int row = 0; row < N; row++)
+		{
+			printf("\t%i", row + 1);
+			for (int col = 0; col < N; col++)
+			{
+				Board square = (Board)1 << (row * N + col);
+				printf("  %c ", (xBoard & square) ? 'X' : (oBoard & square) ? 'O' : '-');
+			}
+			printf("\n\n");
+		}
+
+		if (m_Winner == GameTag::Result_None)
+			printf("%c's turn.\n", (m_Player == GameTag::Player_X) ? 'X' : 'O');
+	}
+
+private:
+
+	/* Adds the chain of one line to the score, see ChainScoreForPlayer. */
+	template<int Line>
+	static inline void AddChain(Board board, Board otherBoard, int &chainScore, int &longestChain)
+	{
+		constexpr Board mask = BoardLinesNK<N, K>::LineMask(Line);
+		if (!(mask & otherBoard))							// Completely ignore blocked lines
+		{
+			int chain = CountBitsU64(mask & board);
+			chainScore += chain * chain;
+			if (chain > longestChain)
+				longestChain = chain;
+		}
+	}
+
+	/* Calls AddChain for every line, expanded at compile time. */
+	template<int... Lines>
+	static inline void AddChains(Board board, Board otherBoard, int &chainScore, int &longestChain, std::integer_sequence<int, Lines...>)
+	{
+		int expand[] = { 0, (AddChain<Lines>(board, otherBoard, chainScore, longestChain), 0)... };
+		(void)expand;
+	}
+
+	/* Private constructor, used in move generation. */
+	BitboardNK(Board xB, Board oB, GameTag player, bool moverWon) :
+		xBoard(xB),
+		oBoard(oB),
+		m_Player(player),
+		m_Winner(moverWon ? ((player == GameTag::Player_X) ? GameTag::Player_O : GameTag::Player_X) :
+				 ((xB | oB) == FULL_BOARD) ? GameTag::Result_Draw : GameTag::Result_None) {}
+
+	/* The bitboards of the 'X' and 'O' players. */
+	Board xBoard;
+	Board oBoard;
+
+	/* The player who is next to make a move. */
+	GameTag m_Player;
+
+	/* The identifier of the winner (x, o, draw, none). */
+	GameTag m_Winner;
+};
+
+/* Definitions of the compile-time masks, for uses that need their address */
+template<int N, int K> constexpr typename BitboardNK<N, K>::Board BitboardNK<N, K>::FULL_BOARD;
+template<int N, int K> constexpr typename BitboardNK<N, K>::Board BitboardNK<N, K>::ROW_STARTS;
+template<int N, int K> constexpr typename BitboardNK<N, K>::Board BitboardNK<N, K>::COLUMN_STARTS;
+template<int N, int K> constexpr typename BitboardNK<N, K>::Board BitboardNK<N, K>::DIAGONAL_STARTS;
+template<int N, int K> constexpr typename BitboardNK<N, K>::Board BitboardNK<N, K>::ANTI_DIAGONAL_STARTS;
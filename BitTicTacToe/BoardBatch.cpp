@@ -0,0 +1,255 @@
+#include "BoardBatch.h"
+#include <stdio.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BOARD_BATCH_AVX2
+#elif defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BOARD_BATCH_SSE2
+#endif
+
+/*
+A small set of operations on vectors of 16-bit lanes, one lane per board.
+The kernels below are written once with these and compiled for the selected instruction set.
+Comparisons set all bits of a lane (0xFFFF) when true, AndNot(a, b) is (~a & b).
+*/
+namespace
+{
+#if defined(BOARD_BATCH_AVX2)
+
+	typedef __m256i Lanes;
+	const int LANE_COUNT = 16;
+	const char *KERNEL_NAME = "AVX2";
+
+	inline Lanes Load(const U16 *p)			 { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+	inline void  Store(U16 *p, Lanes a)		 { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), a); }
+	inline Lanes Set(U16 value)				 { return _mm256_set1_epi16((short)value); }
+	inline Lanes And(Lanes a, Lanes b)		 { return _mm256_and_si256(a, b); }
+	inline Lanes Or(Lanes a, Lanes b)		 { return _mm256_or_si256(a, b); }
+	inline Lanes AndNot(Lanes a, Lanes b)	 { return _mm256_andnot_si256(a, b); }
+	inline Lanes Equal(Lanes a, Lanes b)	 { return _mm256_cmpeq_epi16(a, b); }
+	inline Lanes Add(Lanes a, Lanes b)		 { return _mm256_add_epi16(a, b); }
+	inline Lanes Sub(Lanes a, Lanes b)		 { return _mm256_sub_epi16(a, b); }
+	inline Lanes Mul(Lanes a, Lanes b)		 { return _mm256_mullo_epi16(a, b); }
+	inline Lanes Max(Lanes a, Lanes b)		 { return _mm256_max_epi16(a, b); }
+	inline Lanes ShiftRight1(Lanes a)		 { return _mm256_srli_epi16(a, 1); }
+	inline Lanes ShiftRight2(Lanes a)		 { return _mm256_srli_epi16(a, 2); }
+	inline Lanes ShiftRight4(Lanes a)		 { return _mm256_srli_epi16(a, 4); }
+	inline Lanes ShiftRight8(Lanes a)		 { return _mm256_srli_epi16(a, 8); }
+
+#elif defined(BOARD_BATCH_SSE2)
+
+	typedef __m128i Lanes;
+	const int LANE_COUNT = 8;
+	const char *KERNEL_NAME = "SSE2";
+
+	inline Lanes Load(const U16 *p)			 { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+	inline void  Store(U16 *p, Lanes a)		 { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), a); }
+	inline Lanes Set(U16 value)				 { return _mm_set1_epi16((short)value); }
+	inline Lanes And(Lanes a, Lanes b)		 { return _mm_and_si128(a, b); }
+	inline Lanes Or(Lanes a, Lanes b)		 { return _mm_or_si128(a, b); }
+	inline Lanes AndNot(Lanes a, Lanes b)	 { return _mm_andnot_si128(a, b); }
+	inline Lanes Equal(Lanes a, Lanes b)	 { return _mm_cmpeq_epi16(a, b); }
+	inline Lanes Add(Lanes a, Lanes b)		 { return _mm_add_epi16(a, b); }
+	inline Lanes Sub(Lanes a, Lanes b)		 { return _mm_sub_epi16(a, b); }
+	inline Lanes Mul(Lanes a, Lanes b)		 { return _mm_mullo_epi16(a, b); }
+	inline Lanes Max(Lanes a, Lanes b)		 { return _mm_max_epi16(a, b); }
+	inline Lanes ShiftRight1(Lanes a)		 { return _mm_srli_epi16(a, 1); }
+	inline Lanes ShiftRight2(Lanes a)		 { return _mm_srli_epi16(a, 2); }
+	inline Lanes ShiftRight4(Lanes a)		 { return _mm_srli_epi16(a, 4); }
+	inline Lanes ShiftRight8(Lanes a)		 { return _mm_srli_epi16(a, 8); }
+
+#else
+
+	/* Scalar fallback, a single lane */
+	typedef U16 Lanes;
+	const int LANE_COUNT = 1;
+	const char *KERNEL_NAME = "scalar";
+
+	inline Lanes Load(const U16 *p)			 { return *p; }
+	inline void  Store(U16 *p, Lanes a)		 { *p = a; }
+	inline Lanes Set(U16 value)				 { return value; }
+	inline Lanes And(Lanes a, Lanes b)		 { return a & b; }
+	inline Lanes Or(Lanes a, Lanes b)		 { return a | b; }
+	inline Lanes AndNot(Lanes a, Lanes b)	 { return ~a & b; }
+	inline Lanes Equal(Lanes a, Lanes b)	 { return (a == b) ? 0xFFFF : 0; }
+	inline Lanes Add(Lanes a, Lanes b)		 { return a + b; }
+	inline Lanes Sub(Lanes a, Lanes b)		 { return a - b; }
+	inline Lanes Mul(Lanes a, Lanes b)		 { return a * b; }
+	inline Lanes Max(Lanes a, Lanes b)		 { return (a > b) ? a : b; }
+	inline Lanes ShiftRight1(Lanes a)		 { return a >> 1; }
+	inline Lanes ShiftRight2(Lanes a)		 { return a >> 2; }
+	inline Lanes ShiftRight4(Lanes a)		 { return a >> 4; }
+	inline Lanes ShiftRight8(Lanes a)		 { return a >> 8; }
+
+#endif
+
+	/* Counts the set bits of every lane by adding neighbouring bits, pairs, nibbles and bytes */
+	inline Lanes CountBits(Lanes v)
+	{
+		v = Sub(v, And(ShiftRight1(v), Set(0x5555)));
+		v = Add(And(v, Set(0x3333)), And(ShiftRight2(v), Set(0x3333)));
+		v = And(Add(v, ShiftRight4(v)), Set(0x0F0F));
+		return And(Add(v, ShiftRight8(v)), Set(0x001F));
+	}
+
+	/* Same as Bitboard::GetWinner, lanes are set to the value of the GameTag */
+	inline Lanes WinnerKernel(Lanes x, Lanes o)
+	{
+		Lanes xWin = Set(0), oWin = Set(0);
+		for (int index = 0; index < 10; index++)
+		{
+			Lanes pattern = Set(winPatterns[index]);
+			xWin = Or(xWin, Equal(And(x, pattern), pattern));
+			oWin = Or(oWin, Equal(And(o, pattern), pattern));
+		}
+		Lanes full = Equal(Or(x, o), Set(0xFFFF));
+
+		Lanes result = And(xWin, Set((U16)GameTag::Player_X));
+		result = Or(result, And(AndNot(xWin, oWin), Set((U16)GameTag::Player_O)));
+		result = Or(result, And(AndNot(Or(xWin, oWin), full), Set((U16)GameTag::Result_Draw)));
+		return result;
+	}
+
+	/* Same as Bitboard::GetClearBitsCount */
+	inline Lanes ClearBitsKernel(Lanes x, Lanes o)
+	{
+		return CountBits(AndNot(Or(x, o), Set(0xFFFF)));
+	}
+
+	/* Same as Bitboard::ChainScoreForPlayer */
+	inline Lanes ChainScoreKernel(Lanes board, Lanes otherBoard)
+	{
+		Lanes chainScore = Set(0), longestChain = Set(0);
+		for (int index = 0; index < 10; index++)
+		{
+			Lanes pattern = Set(winPatterns[index]);
+			Lanes open = Equal(And(otherBoard, pattern), Set(0));				// Blocked patterns are ignored
+			Lanes chain = And(CountBits(And(board, pattern)), open);
+			chainScore = Add(chainScore, Mul(chain, chain));
+			longestChain = Max(longestChain, chain);
+		}
+		return Add(chainScore, longestChain);
+	}
+}
+
+void BoardBatch::Clear()
+{
+	m_XBoards.clear();
+	m_OBoards.clear();
+	m_Count = 0;
+}
+
+void BoardBatch::Add(const Bitboard &board)
+{
+	Add(board.GetXBoard(), board.GetOBoard());
+}
+
+void BoardBatch::Add(U16 xB, U16 oB)
+{
+	// Grow by a whole vector of empty boards, so kernels never read past the end
+	if (m_Count == (int)m_XBoards.size())
+	{
+		m_XBoards.resize(m_Count + 16, 0);
+		m_OBoards.resize(m_Count + 16, 0);
+	}
+	m_XBoards[m_Count] = xB;
+	m_OBoards[m_Count] = oB;
+	m_Count++;
+}
+
+void BoardBatch::ComputeWinners(GameTag *winners) const
+{
+	U16 results[LANE_COUNT];
+	for (int first = 0; first < m_Count; first += LANE_COUNT)
+	{
+		Store(results, WinnerKernel(Load(&m_XBoards[first]), Load(&m_OBoards[first])));
+		for (int lane = 0; lane < LANE_COUNT && first + lane < m_Count; lane++)
+			winners[first + lane] = (GameTag)results[lane];
+	}
+}
+
+void BoardBatch::ComputeClearBitsCounts(int *counts) const
+{
+	U16 results[LANE_COUNT];
+	for (int first = 0; first < m_Count; first += LANE_COUNT)
+	{
+		Store(results, ClearBitsKernel(Load(&m_XBoards[first]), Load(&m_OBoards[first])));
+		for (int lane = 0; lane < LANE_COUNT && first + lane < m_Count; lane++)
+			counts[first + lane] = results[lane];
+	}
+}
+
+void BoardBatch::ComputeChainScores(GameTag player, int *scores) const
+{
+	// Use the player's boards to count score, and the other boards to exclude blocked patterns
+	const std::vector<U16> &boards = (player == GameTag::Player_O) ? m_OBoards : m_XBoards;
+	const std::vector<U16> &otherBoards = (player == GameTag::Player_O) ? m_XBoards : m_OBoards;
+
+	U16 results[LANE_COUNT];
+	for (int first = 0; first < m_Count; first += LANE_COUNT)
+	{
+		Store(results, ChainScoreKernel(Load(&boards[first]), Load(&otherBoards[first])));
+		for (int lane = 0; lane < LANE_COUNT && first + lane < m_Count; lane++)
+			scores[first + lane] = results[lane];
+	}
+}
+
+const char *BoardBatch::GetKernelName()
+{
+	return KERNEL_NAME;
+}
+
+bool BoardBatch::ValidateKernels(int samples, bool verbose)
+{
+	/* Collect boards from random games, including finished ones */
+	std::vector<Bitboard> boards;
+	BoardBatch batch;
+	unsigned int seed = 12345;
+	while ((int)boards.size() < samples)
+	{
+		Bitboard board((boards.size() & 1) ? GameTag::Player_O : GameTag::Player_X);
+		boards.push_back(board);
+		batch.Add(board);
+
+		while (board.GetWinner() == GameTag::Result_None && (int)boards.size() < samples)
+		{
+			MoveList moves;
+			board.GetAvailableMoves(moves);
+			seed = seed * 1103515245 + 12345;		// Small LCG, the sequence only has to be repeatable
+			board = board.DoMoveUnchecked(moves.moves[(seed >> 16) % moves.count]);
+			boards.push_back(board);
+			batch.Add(board);
+		}
+	}
+
+	std::vector<GameTag> winners(samples);
+	std::vector<int> counts(samples), xScores(samples), oScores(samples);
+	batch.ComputeWinners(winners.data());
+	batch.ComputeClearBitsCounts(counts.data());
+	batch.ComputeChainScores(GameTag::Player_X, xScores.data());
+	batch.ComputeChainScores(GameTag::Player_O, oScores.data());
+
+	int mismatches = 0;
+	for (int index = 0; index < samples; index++)
+	{
+		Bitboard &board = boards[index];
+		if (winners[index] != board.GetWinner() ||
+			counts[index]  != board.GetClearBitsCount() ||
+			xScores[index] != board.ChainScoreForPlayer(GameTag::Player_X) ||
+			oScores[index] != board.ChainScoreForPlayer(GameTag::Player_O))
+		{
+			if (verbose && mismatches < 10)
+			{
+				printf("Mismatch on board %i:", index);
+				board.Print();
+			}
+			mismatches++;
+		}
+	}
+
+	if (verbose)
+		printf("Board batch kernels (%s): %i boards checked, %i mismatches.\n", KERNEL_NAME, samples, mismatches);
+	return mismatches == 0;
+}
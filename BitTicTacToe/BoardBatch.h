@@ -0,0 +1,53 @@
+#pragma once
+#include "Bitboard.h"
+#include <vector>
+
+/*
+Many boards stored as a structure of arrays (all xBoards, then all oBoards),
+so board functions can run on 16 boards at once with AVX2, or 8 with SSE2.
+
+The kernel is chosen at compile time: AVX2 if the compiler targets it (/arch:AVX2),
+otherwise SSE2 (always available on x64), otherwise a scalar loop.
+Results are the same as the matching Bitboard functions, see ValidateKernels.
+*/
+class BoardBatch
+{
+public:
+
+	BoardBatch() : m_Count(0) {}
+
+	~BoardBatch() {}
+
+	/* Remove all boards from the batch. */
+	void Clear();
+
+	/* Add a board to the end of the batch. */
+	void Add(const Bitboard &board);
+	void Add(U16 xB, U16 oB);
+
+	/* Returns the number of boards in the batch. */
+	inline int GetCount() const { return m_Count; }
+
+	/* Fills winners with the result of every board, like Bitboard::GetWinner. */
+	void ComputeWinners(GameTag *winners) const;
+
+	/* Fills counts with the number of clear bits of every board, like Bitboard::GetClearBitsCount. */
+	void ComputeClearBitsCounts(int *counts) const;
+
+	/* Fills scores with the chain score of every board, like Bitboard::ChainScoreForPlayer. */
+	void ComputeChainScores(GameTag player, int *scores) const;
+
+	/* Returns the name of the instruction set used by the kernels. */
+	static const char *GetKernelName();
+
+	/* Compare the kernels with the Bitboard functions on random boards, returns true if all match. */
+	static bool ValidateKernels(int samples = 100000, bool verbose = true);
+
+private:
+
+	/* Both arrays are padded with empty boards to a multiple of the vector width. */
+	std::vector<U16> m_XBoards;
+	std::vector<U16> m_OBoards;
+
+	int m_Count;
+};
@@ -0,0 +1,86 @@
+#include "EndgameSolver.h"
+
+/* Returns the clear squares that would complete a win pattern of the board, as in Bitboard::GetWinningSquares */
+static inline U16 WinningSquares(U16 board, U16 clear)
+{
+	U16 squares = 0;
+	for (int index = 0; index < 10; index++)
+	{
+		U16 missing = winPatterns[index] & ~board;
+		if ((missing & (missing - 1)) == 0)
+			squares |= missing;
+	}
+	return squares & clear;
+}
+
+int EndgameSolver::Solve(const Bitboard &board, int alpha, int beta, int winValue, int drawValue, SearchStats &stats)
+{
+	stats.endgameSolves++;
+
+	GameTag winner = board.GetWinner();
+	if (winner == GameTag::Result_Draw)
+		return drawValue;
+	if (winner != GameTag::Result_None)
+		return -(winValue + board.GetClearBitsCount());		// The last move won
+
+	bool isX = (board.GetPlayerTag() == GameTag::Player_X);
+	U16 player = isX ? board.GetXBoard() : board.GetOBoard();
+	U16 other = isX ? board.GetOBoard() : board.GetXBoard();
+	return Search(player, other, alpha, beta, winValue, drawValue, stats.endgameNodes);
+}
+
+int EndgameSolver::Search(U16 player, U16 other, int alpha, int beta, int winValue, int drawValue, U64 &nodes)
+{
+	nodes++;
+
+	U16 clear = (U16)~(player | other);
+	if (clear == 0)
+		return drawValue;
+	int clearBits = CountBitsU16(clear);
+
+	if (WinningSquares(player, clear))
+		return winValue + clearBits - 1;
+
+	U16 threats = WinningSquares(other, clear);
+	if (threats & (threats - 1))
+		return -(winValue + clearBits - 2);
+	if (threats)
+		return -Search(other, player | threats, -beta, -alpha, winValue, -drawValue, nodes);
+
+	/*
+	Neither player wins on its next move here, so the fastest win is on the move after (3 squares less),
+	and the fastest loss on the other player's second move (4 squares less).
+	*/
+	if (clearBits >= 4 && alpha < -(winValue + clearBits - 4))
+		alpha = -(winValue + clearBits - 4);
+	if (clearBits >= 3 && beta > winValue + clearBits - 3)
+		beta = winValue + clearBits - 3;
+	if (alpha >= beta)
+		return alpha;
+
+	/* Moves that make a winning square (a threat the other player must block) come first */
+	U16 threatMoves = 0;
+	for (U16 moves = clear; moves; )
+	{
+		U16 move = Bitboard::PopMove(moves);
+		if (WinningSquares(player | move, clear ^ move))
+			threatMoves |= move;
+	}
+
+	int bestValue = -2147483647;
+	for (int pass = 0; pass < 2; pass++)
+		for (U16 moves = (pass == 0) ? threatMoves : (U16)(clear & ~threatMoves); moves; )
+		{
+			U16 move = Bitboard::PopMove(moves);
+			int value = -Search(other, player | move, -beta, -alpha, winValue, -drawValue, nodes);
+			if (value > bestValue)
+			{
+				bestValue = value;
+				if (value > alpha)
+					alpha = value;
+				if (alpha >= beta)
+					return bestValue;
+			}
+		}
+	return bestValue;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "Bitboard.h"
+#include "SearchStats.h"
+
+/*
+ENDGAME SOLVER
+
+	Solves boards with few clear squares exactly, to the end of the game, for PlayerMinimax.
+	There is no evaluation: the only values are wins, losses and draws, so the search works on
+	the two raw player boards and finds wins with the winning-square masks, without building Bitboards.
+
+	A player with a winning square wins on this move, and otherwise none of its moves wins,
+	so the game can only end by the other player's win or a full board. The other player's winning squares
+	decide the rest: two of them lose, one is a forced block, and only with none is every move searched.
+	Moves that make a winning square of their own are searched first.
+
+	Values are those of PlayerMinimax::GetStaticValue for the player to move: the win value plus the clear squares
+	left when the game ends for a win, the negation for a loss, and the draw value (see PlayerMinimax::GetDrawValue)
+	for a draw, negated on the other player's moves. The search is recursive on the stack,
+	it allocates nothing and keeps no table, and is thread safe.
+*/
+class EndgameSolver
+{
+public:
+
+	/*
+	Returns the value of the board for the player to move, fail-soft within the window alpha, beta:
+	exact inside it, otherwise a bound on the side it falls. drawValue is the value of a draw for the player to move,
+	it must be smaller than any win value. Counts the solve and its nodes in stats.
+	*/
+	static int Solve(const Bitboard &board, int alpha, int beta, int winValue, int drawValue, SearchStats &stats);
+
+private:
+
+	/* The recursive search, the board of the player to move is 'player'. Neither board has won. */
+	static int Search(U16 player, U16 other, int alpha, int beta, int winValue, int drawValue, U64 &nodes);
+};
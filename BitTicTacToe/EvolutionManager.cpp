@@ -99,7 +99,7 @@ void EvolutionManager::PlayAgainstBest()
 	printf("\nPlayer score: %i after %i games\n", bestPlayer->GetFitnessValue(), bestPlayer->GetGamesPlayed());
 
 	// Use the nn of best player, but use greater search depth and more suitable parameters for human-computer games
-	PlayerEvolutionary betterBestPlayer = PlayerEvolutionary(bestPlayer->GetNetwork(), GameTag::Player_X, m_SearchDepth+2, 4, true, false);
+	PlayerEvolutionary betterBestPlayer = PlayerEvolutionary(bestPlayer->GetNetwork(), GameTag::Player_X, m_SearchDepth+2, 4, true, false, 18);
 
 	GameManager gmng = GameManager(&betterBestPlayer, new PlayerHuman(GameTag::Player_O));
 	gmng.PlayGame();
@@ -108,6 +108,10 @@ void EvolutionManager::PlayAgainstBest()
 void EvolutionManager::Play()
 {
 	int stats[] = { 0,0,0 };
+
+	// One opponent plays every game with the network of a random player, its table and threads are kept (see NewGame)
+	PlayerEvolutionary opponent = PlayerEvolutionary(GameTag::Player_O, m_SearchDepth, m_ThreadsPerPlayer, false, false);
+
 	/* Each player plays a number of games with random opponents */
 	for (PlayerEvolutionary &player : m_Population)	
 	{
@@ -118,8 +122,7 @@ void EvolutionManager::Play()
 			PlayerEvolutionary *otherPlayer = &m_Population[NeuralNet::GetRandomInt(0, (int)m_Population.size() - 1)];	
 			
 			// other player, player tag O
-			PlayerEvolutionary opponent = PlayerEvolutionary(otherPlayer->GetNetwork(), 
-				GameTag::Player_O, m_SearchDepth, m_ThreadsPerPlayer, false, false);
+			opponent.GetNetwork() = otherPlayer->GetNetwork();
 
 			//static PlayerMinimax opponent = PlayerMinimax(GameTag::Player_O, m_SearchDepth, true, m_ThreadsPerPlayer, false);
 
@@ -150,6 +153,8 @@ GameTag EvolutionManager::RunGameLoop(PlayerMinimax *player, PlayerMinimax *oppo
 {
 	Bitboard board = Bitboard();
 	PlayerMinimax *currPlayer = player;
+	player->NewGame();
+	opponent->NewGame();
 	do
 	{
 		board = board.DoMove(currPlayer->GetMove(board), currPlayer->GetPlayerTag());
@@ -1,4 +1,5 @@
 #include "GameManager.h"
+#include "MoveRequest.h"
 #include <stdio.h>
 #include <iostream>
 #include <chrono>
@@ -11,8 +12,10 @@ void GameManager::PlayGame(bool askAgain, bool verbose)
 	if (Player1->GetPlayerTag() == Player2->GetPlayerTag())
 		throw exception("Players must have different tags.");
 
-	/* Start with an empty board */
+	/* Start with an empty board, players drop what they kept from the last game */
 	board = Bitboard(cPlayer->GetPlayerTag());
+	Player1->NewGame();
+	Player2->NewGame();
 	if (verbose)	board.Print();
 
 
@@ -30,10 +33,22 @@ void GameManager::PlayGame(bool askAgain, bool verbose)
 	{
 		/* Ask the player for a move and record the time it took to return. */
 		auto start = std::chrono::high_resolution_clock::now();
-		U16 nextMove = cPlayer->GetMove(board);
+		U16 nextMove;
+		if (moveTimeLimit > 0)
+		{
+			/* The search runs on another thread, which is stopped when the time is up. */
+			MoveRequest request = cPlayer->GetMoveAsync(board, std::chrono::steady_clock::now() + std::chrono::milliseconds(moveTimeLimit));
+			nextMove = request.Get();
+		}
+		else
+			nextMove = cPlayer->GetMove(board);
 		auto end = std::chrono::high_resolution_clock::now();
 		std::chrono::duration<float, std::milli> elapsed = end - start;
 
+		/* The other player may have been thinking meanwhile, tell it which move was played. */
+		Player *otherPlayer = (cPlayer == Player1) ? Player2 : Player1;
+		otherPlayer->StopPondering((nextMove == ABORT_GAME) ? 0 : nextMove);
+
 		if (nextMove == ABORT_GAME)
 		{
 			printf("Game aborted.\n");
@@ -48,10 +63,12 @@ void GameManager::PlayGame(bool askAgain, bool verbose)
 		stats_average += elapsed; turns++;
 		if (verbose) printf("Move returned in %f ms\n", elapsed.count());
 
-		/* Update the board with the latest move, print it and switch players. */
+		/* Update the board with the latest move, print it and switch players. The player who moved may ponder. */
 		board = board.DoMove(nextMove, cPlayer->GetPlayerTag());
 		if (verbose) board.Print();
-		cPlayer = (cPlayer == Player1) ? Player2 : Player1;
+		if (board.GetWinner() == GameTag::Result_None)
+			cPlayer->StartPondering(board);
+		cPlayer = otherPlayer;
 	} 
 
 	/* Display the result (winner) of the last match and add score to winner. */
@@ -17,6 +17,9 @@ public:
 	/* Start the game */
 	void PlayGame(bool askAgain=true, bool verbose=true);
 
+	/* Stop players that think longer than this and play their best move so far. 0 for no limit. */
+	void SetMoveTimeLimit(int milliseconds) { moveTimeLimit = (milliseconds > 0) ? milliseconds : 0; }
+
 	/* Display a question with a given message and return true or false. */
 	static bool DisplayPolarQuestion(std::string message);
 
@@ -36,6 +39,9 @@ private:
 	/* The current game board. */
 	Bitboard board;
 
+	/* Milliseconds a player may think about a move, 0 for no limit. */
+	int moveTimeLimit = 0;
+
 	/* Scores of players and draws. */
 	int xScore;
 	int oScore;
@@ -4,6 +4,12 @@
 #include "PlayerEvolutionary.h"
 #include "EvolutionManager.h"
 #include "PlayerMinimaxLookup.h"
+#include "PlayerTablebase.h"
+#include "PlayerProofNumber.h"
+#include "PlayerMCTS.h"
+#include "Tablebase.h"
+#include "BoardBatch.h"
+#include "Perft.h"
 #include <iostream>
 #include <fstream>
 
@@ -30,29 +36,54 @@ Player *GetPlayer(GameTag tag, int playerNum)
 	do
 	{
 		printf("Select player #%i type: ", playerNum);
-		player = GameManager::DisplayNumberQuestion("\n    1) Human \n    2) Minimax \n    3) Minimax-lookup \n    4) Minimax-neural");
-	} while (player < 1 || player > 4);
+		player = GameManager::DisplayNumberQuestion("\n    1) Human \n    2) Minimax \n    3) Minimax-lookup \n    4) Minimax-neural \n    5) Tablebase \n    6) Proof-number solver \n    7) Monte Carlo tree search");
+	} while (player < 1 || player > 7);
 
 	if (player == 1)
 		return new PlayerHuman(tag);
-	int searchDepth = GameManager::DisplayNumberQuestion("Enter search depth:");
+	if (player == 5)
+		return new PlayerTablebase(tag);
+	if (player == 6)
+		return new PlayerProofNumber(tag);
+	if (player == 7)
+	{
+		int timeLimit = GameManager::DisplayNumberQuestion("Enter time per move in ms (0 to use a number of iterations):");
+		PlayerMCTS *mcts = new PlayerMCTS(tag, (timeLimit > 0) ? 1 : GameManager::DisplayNumberQuestion("Enter iterations per move:"));
+		mcts->SetTimeLimit(timeLimit);
+		return mcts;
+	}
 	if (player == 2)
-		return new PlayerMinimax(tag, searchDepth, false);
+	{
+		int algorithm = GameManager::DisplayNumberQuestion("Search algorithm:\n    1) Alpha-beta\n    2) Principal variation search");
+		int timeLimit = GameManager::DisplayNumberQuestion("Enter time per move in ms (0 to use a search depth):");
+		PlayerMinimax *minimax = new PlayerMinimax(tag, (timeLimit > 0) ? 16 : GameManager::DisplayNumberQuestion("Enter search depth:"), false);
+		minimax->SetTimeLimit(timeLimit);
+		if (algorithm == 2)
+			minimax->SetSearchAlgorithm(SearchAlgorithm::PVS);
+		if (GameManager::DisplayPolarQuestion("Play forced moves past the search depth (quiescence search)?"))
+			minimax->SetQuiescencePlies(QUIESCENCE_PLIES);
+		if (GameManager::DisplayPolarQuestion("Solve the end of the game exactly (endgame solver)?"))
+			minimax->SetEndgameThreshold(ENDGAME_THRESHOLD);
+		minimax->SetPondering(GameManager::DisplayPolarQuestion("Think on the opponent's time?"));
+		return minimax;
+	}
+	int searchDepth = GameManager::DisplayNumberQuestion("Enter search depth:");
 	if (player == 3)
 		return new PlayerMinimaxLookup(tag, searchDepth);
 	else // player == 4
-		return new PlayerEvolutionary(tag, searchDepth);
+		return new PlayerEvolutionary(tag, searchDepth, 4, false, false, 18);	// A full size table for deeper games
 
 }
 
 void StartGame()
 {
 	LoadExtension();
-	int option = GameManager::DisplayNumberQuestion("Main menu:\n    1) Play game\n    2) Enter evolution menu\n    3) Bake lookup\n    0) Quit");
+	int option = GameManager::DisplayNumberQuestion("Main menu:\n    1) Play game\n    2) Enter evolution menu\n    3) Bake lookup\n    4) Build tablebase\n    5) Validate board kernels\n    6) Perft benchmark\n    0) Quit");
 	if (option == 1)
 	{
 		Player *p1 = GetPlayer(GameTag::Player_X, 1);	// Display x player promt first
 		GameManager manager(p1, GetPlayer(GameTag::Player_O, 2));
+		manager.SetMoveTimeLimit(GameManager::DisplayNumberQuestion("Stop players who think longer than this many ms per move (0 for no limit):"));
 		manager.PlayGame();
 	}
 	else if (option == 2)
@@ -73,6 +104,19 @@ void StartGame()
 			bakemng2.PlayGame(false, false);
 		}
 	}
+	else if (option == 4)
+	{
+		Tablebase::Generate("_tablebase.dat", GameManager::DisplayNumberQuestion("Number of threads"));
+	}
+	else if (option == 5)
+	{
+		BoardBatch::ValidateKernels();
+	}
+	else if (option == 6)
+	{
+		int depth = GameManager::DisplayNumberQuestion("Maximum depth (8 takes a few seconds)");
+		Perft::RunBenchmark(depth, GameManager::DisplayNumberQuestion("Number of threads"));
+	}
 	if (option != 0)
 		StartGame();	// Display message again
 }
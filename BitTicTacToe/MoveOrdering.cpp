@@ -0,0 +1,82 @@
+#include "MoveOrdering.h"
+
+using namespace std;
+
+// Scores above any history score, for the hash move and killers
+static const U32 HASH_MOVE_SCORE = 0xFFFFFFFF;
+static const U32 KILLER_SCORE	 = 0xFFFFFFF0;
+static const U32 HISTORY_LIMIT	 = 0x10000000;
+
+void MoveOrdering::Clear()
+{
+	for (int ply = 0; ply < 16; ply++)
+	{
+		m_Killers[ply][0].store(0, memory_order_relaxed);
+		m_Killers[ply][1].store(0, memory_order_relaxed);
+	}
+	for (int side = 0; side < 2; side++)
+		for (int square = 0; square < 16; square++)
+			m_History[side][square].store(0, memory_order_relaxed);
+}
+
+void MoveOrdering::NewSearch()
+{
+	for (int side = 0; side < 2; side++)
+		for (int square = 0; square < 16; square++)
+			m_History[side][square].store(m_History[side][square].load(memory_order_relaxed) / 2, memory_order_relaxed);
+}
+
+void MoveOrdering::OrderMoves(const Bitboard &board, MoveList &moves, U16 hashMove) const
+{
+	int side = GetSide(board);
+	int ply = GetPly(board);
+	U16 killer1 = m_Killers[ply][0].load(memory_order_relaxed);
+	U16 killer2 = m_Killers[ply][1].load(memory_order_relaxed);
+
+	U32 scores[16];
+	for (int index = 0; index < moves.count; index++)
+	{
+		U16 move = moves.moves[index];
+		if (move == hashMove)
+			scores[index] = HASH_MOVE_SCORE;
+		else if (move == killer1)
+			scores[index] = KILLER_SCORE;
+		else if (move == killer2)
+			scores[index] = KILLER_SCORE - 1;
+		else
+			scores[index] = m_History[side][GetSquare(move)].load(memory_order_relaxed);
+	}
+
+	/* Insertion sort, there are 16 moves at most. Equal scores keep the move generation order */
+	for (int index = 1; index < moves.count; index++)
+	{
+		U16 move = moves.moves[index];
+		U32 score = scores[index];
+		int position = index;
+		for (; position > 0 && scores[position - 1] < score; position--)
+		{
+			moves.moves[position] = moves.moves[position - 1];
+			scores[position] = scores[position - 1];
+		}
+		moves.moves[position] = move;
+		scores[position] = score;
+	}
+}
+
+void MoveOrdering::RecordCutoff(const Bitboard &board, U16 move, int depth)
+{
+	int ply = GetPly(board);
+
+	// Keep two different killers, the newest first
+	if (m_Killers[ply][0].load(memory_order_relaxed) != move)
+	{
+		m_Killers[ply][1].store(m_Killers[ply][0].load(memory_order_relaxed), memory_order_relaxed);
+		m_Killers[ply][0].store(move, memory_order_relaxed);
+	}
+
+	// Deep cutoffs save more work, so they count more. Scores are halved before they get near the killer scores
+	atomic<U32> &history = m_History[GetSide(board)][GetSquare(move)];
+	U32 score = history.fetch_add((U32)(depth * depth), memory_order_relaxed) + (U32)(depth * depth);
+	if (score > HISTORY_LIMIT)
+		history.store(score / 2, memory_order_relaxed);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "Bitboard.h"
+#include <atomic>
+
+/*
+Orders the moves of a search so the ones most likely to cause a cutoff are searched first:
+	1. The hash move, the best move stored in the transposition table for the board
+	2. Killer moves, two moves per ply that recently caused a cutoff on another board of the same ply
+	3. All other moves by their history score, how often and how deep they caused cutoffs so far
+
+Killers and history are shared by all worker threads of a search. Every value is a relaxed atomic,
+a lost update only makes the ordering slightly worse, never the result wrong.
+Plies are counted from the start of the game (occupied squares), so they are the same for every
+iteration, thread and move of a game, and killers are kept until the game ends.
+Copying the object copies nothing, the copy starts empty.
+*/
+class MoveOrdering
+{
+public:
+
+	MoveOrdering() { Clear(); }
+	MoveOrdering(const MoveOrdering &) { Clear(); }
+	MoveOrdering &operator=(const MoveOrdering &) { return *this; }
+
+	~MoveOrdering() {}
+
+	/* Forget all killers and history. */
+	void Clear();
+
+	/* Start a new search, history is halved so recent cutoffs weigh more. Not thread safe, call before searching. */
+	void NewSearch();
+
+	/* Sort the moves of a board, best first. The hash move may be 0 if there isn't one. */
+	void OrderMoves(const Bitboard &board, MoveList &moves, U16 hashMove) const;
+
+	/* Remember a move that caused a cutoff at the given remaining depth. */
+	void RecordCutoff(const Bitboard &board, U16 move, int depth);
+
+private:
+
+	static inline int GetSide(const Bitboard &board) { return (board.GetPlayerTag() == GameTag::Player_X) ? 0 : 1; }
+	static inline int GetPly(const Bitboard &board) { return 16 - board.GetClearBitsCount(); }
+	static inline int GetSquare(U16 move) { return CountBitsU16((U16)(move - 1)); }
+
+	/* Two killer moves for every ply, the newest first */
+	std::atomic<U16> m_Killers[16][2];
+
+	/* Cutoff score of every square for each side */
+	std::atomic<U32> m_History[2][16];
+};
@@ -0,0 +1,78 @@
+#include "MoveRequest.h"
+
+using namespace std;
+
+MoveRequest Player::GetMoveAsync(Bitboard board)
+{
+	return MoveRequest(this, board, MoveRequest::Clock::time_point::max());
+}
+
+MoveRequest Player::GetMoveAsync(Bitboard board, std::chrono::steady_clock::time_point deadline)
+{
+	return MoveRequest(this, board, deadline);
+}
+
+MoveRequest::MoveRequest(Player *player, const Bitboard &board, Clock::time_point deadline) :
+	m_Player(player),
+	m_Request(player->ReserveSearch()),
+	m_Deadline(deadline),
+	m_bDone(false),
+	m_Move(0)
+{
+	// Reserved first, so a Stop that comes before the search begins still stops it
+	m_Result = async(launch::async, [player, board]() { return player->GetMove(board); });
+}
+
+MoveRequest::MoveRequest(MoveRequest &&other) :
+	m_Player(other.m_Player),
+	m_Request(other.m_Request),
+	m_Result(move(other.m_Result)),
+	m_Deadline(other.m_Deadline),
+	m_bDone(other.m_bDone),
+	m_Move(other.m_Move)
+{
+	other.m_Player = nullptr;
+}
+
+MoveRequest::~MoveRequest()
+{
+	if (m_Player && !m_bDone)
+	{
+		// Exceptions of GetMove are dropped, only Get reports them
+		Stop();
+		Wait();
+	}
+}
+
+void MoveRequest::Stop()
+{
+	m_Player->StopRequest(m_Request);
+}
+
+bool MoveRequest::IsReady()
+{
+	return m_bDone || m_Result.wait_for(chrono::seconds(0)) == future_status::ready;
+}
+
+U16 MoveRequest::Get()
+{
+	if (!m_bDone)
+	{
+		Wait();
+		m_Move = m_Result.get();
+		m_bDone = true;
+	}
+	return m_Move;
+}
+
+U16 MoveRequest::GetBestMoveSoFar()
+{
+	return m_bDone ? m_Move : m_Player->GetBestMoveSoFar();
+}
+
+void MoveRequest::Wait()
+{
+	if (m_Deadline != Clock::time_point::max() && m_Result.wait_until(m_Deadline) != future_status::ready)
+		Stop();
+	m_Result.wait();
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "Player.h"
+#include <chrono>
+#include <future>
+
+/*
+A move being searched on another thread, returned by Player::GetMoveAsync.
+
+Stop asks the player to return its best move so far, and so does reaching the deadline while waiting in Get.
+The search is numbered before it starts (Player::ReserveSearch), so a stop is never lost or applied to another move.
+Players that can't stop (a human) finish their move normally.
+The player must not be used for anything else until the move is returned, and a request must not outlive its player:
+destroying an unfinished request stops the search and waits for it.
+*/
+class MoveRequest
+{
+public:
+
+	typedef std::chrono::steady_clock Clock;
+
+	/* Start searching. A deadline of Clock::time_point::max() means none. */
+	MoveRequest(Player *player, const Bitboard &board, Clock::time_point deadline);
+
+	MoveRequest(MoveRequest &&other);
+	MoveRequest(const MoveRequest &) = delete;
+	MoveRequest &operator=(const MoveRequest &) = delete;
+
+	~MoveRequest();
+
+	/* Ask the player to return its best move so far, without waiting for it. Thread safe. */
+	void Stop();
+
+	/* Returns true if the move was returned, Get won't wait. */
+	bool IsReady();
+
+	/* Waits for the move and returns it, stopping the search at the deadline. Rethrows exceptions of GetMove. */
+	U16 Get();
+
+	/* Returns the move of a finished request, or the player's best move so far, 0 if it has none yet. */
+	U16 GetBestMoveSoFar();
+
+private:
+
+	/* Waits until GetMove returns, stopping it at the deadline */
+	void Wait();
+
+	Player *m_Player;
+	unsigned m_Request;				// Number of the search of this request, see Player::ReserveSearch
+	std::future<U16> m_Result;
+	Clock::time_point m_Deadline;
+
+	// The move, once it was taken from m_Result
+	bool m_bDone;
+	U16 m_Move;
+};
@@ -0,0 +1,165 @@
+#include "ParallelSearch.h"
+
+using namespace std;
+
+void SearchThreadPool::BeginSearch(int helperCount, const SplitPointWork &work, bool spinWhileIdle)
+{
+	if (helperCount != GetHelperCount())
+	{
+		StopThreads();
+		for (int index = 0; index < helperCount; index++)
+			m_Helpers.push_back(unique_ptr<SearchThread>(new SearchThread(this, true)));
+		for (int index = 0; index < helperCount; index++)
+			m_Threads.push_back(thread(&SearchThreadPool::HelperLoop, this, m_Helpers[index].get()));
+	}
+
+	{
+		// Every helper is asleep (see EndSearch), so the work may be replaced
+		lock_guard<mutex> guard(m_Mutex);
+		m_Work = work;
+		m_bSpinWhileIdle = spinWhileIdle;
+		m_bSearching = true;
+	}
+	m_WakeUp.notify_all();
+}
+
+void SearchThreadPool::EndSearch()
+{
+	m_bSearching = false;
+	for (unique_ptr<SearchThread> &helper : m_Helpers)
+		helper->Wake();
+
+	// Wait until all helpers sleep, so the next search starts from a known state
+	unique_lock<mutex> lock(m_Mutex);
+	m_Parked.wait(lock, [this]() { return m_ParkedCount == m_Helpers.size(); });
+}
+
+void SearchThreadPool::HelperLoop(SearchThread *helper)
+{
+	while (true)
+	{
+		{
+			unique_lock<mutex> lock(m_Mutex);
+			m_ParkedCount++;
+			m_Parked.notify_all();
+			m_WakeUp.wait(lock, [this]() { return m_bQuit || m_bSearching; });
+			m_ParkedCount--;
+			if (m_bQuit)
+				return;
+		}
+
+		int spins = 0;
+		while (m_bSearching.load(memory_order_relaxed))
+		{
+			SplitPoint *sp = helper->work.load();
+			if (!sp)
+			{
+				// Another split point is usually close, but don't keep a core busy when none comes
+				if (m_bSpinWhileIdle && spins++ < IDLE_SPINS)
+					this_thread::yield();
+				else
+				{
+					unique_lock<mutex> lock(helper->sleepLock);
+					helper->wakeUp.wait(lock, [helper, this]() { return helper->work.load() || !m_bSearching; });
+				}
+				continue;
+			}
+			spins = 0;
+
+			helper->activeSplit = sp;
+			m_Work(*helper, *sp);
+			helper->activeSplit = nullptr;
+
+			// The split point may be gone once its slaves are done, it's not used after this
+			helper->work = nullptr;
+			sp->Leave();
+			helper->idle = true;
+		}
+	}
+}
+
+void SearchThreadPool::StopThreads()
+{
+	{
+		lock_guard<mutex> guard(m_Mutex);
+		m_bQuit = true;
+	}
+	m_WakeUp.notify_all();
+
+	for (thread &t : m_Threads)
+		t.join();
+
+	m_Threads.clear();
+	m_Helpers.clear();
+	m_ParkedCount = 0;
+	m_bQuit = false;
+}
+
+WorkerThreads &WorkerThreads::operator=(const WorkerThreads &other)
+{
+	if (this != &other && other.GetHelperCount() != GetHelperCount())
+	{
+		StopThreads();
+		Start(other.GetHelperCount());
+	}
+	return *this;
+}
+
+void WorkerThreads::Start(int helperCount)
+{
+	for (int index = 1; index <= helperCount; index++)
+		m_Threads.push_back(thread(&WorkerThreads::ThreadLoop, this, index, m_Run));
+}
+
+void WorkerThreads::Run(const Work &work)
+{
+	{
+		lock_guard<mutex> guard(m_Mutex);
+		m_Work = &work;
+		m_Running = GetHelperCount();
+		m_Run++;
+	}
+	m_Started.notify_all();
+
+	work(0);
+
+	// The work is owned by the caller, it must not be used after returning
+	unique_lock<mutex> lock(m_Mutex);
+	m_Finished.wait(lock, [this]() { return m_Running == 0; });
+	m_Work = nullptr;
+}
+
+void WorkerThreads::ThreadLoop(int threadIndex, unsigned run)
+{
+	unique_lock<mutex> lock(m_Mutex);
+	while (true)
+	{
+		m_Started.wait(lock, [this, run]() { return m_bQuit || m_Run != run; });
+		if (m_bQuit)
+			return;
+		run = m_Run;
+
+		const Work *work = m_Work;
+		lock.unlock();
+		(*work)(threadIndex);
+		lock.lock();
+
+		if (--m_Running == 0)
+			m_Finished.notify_one();
+	}
+}
+
+void WorkerThreads::StopThreads()
+{
+	{
+		lock_guard<mutex> guard(m_Mutex);
+		m_bQuit = true;
+	}
+	m_Started.notify_all();
+
+	for (thread &t : m_Threads)
+		t.join();
+
+	m_Threads.clear();
+	m_bQuit = false;
+}
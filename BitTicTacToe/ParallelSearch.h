@@ -0,0 +1,256 @@
+#pragma once
+#include "Bitboard.h"
+#include "SearchStats.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+PARALLEL SEARCH (Young Brothers Wait)
+
+	A node is searched by one thread until its first move (the eldest brother) is done.
+	Its remaining moves may then be shared with idle threads: the node becomes a split point,
+	and every thread working on it takes the next unsearched move until none remain.
+	Threads which run out of work wait until they are booked for another split point, at any depth.
+
+	Values, bounds and the best move of a split point are shared by its threads, so a better alpha
+	found by one thread is used by the next move any of them takes. When a move fails high,
+	the split point is cut off and every thread below it returns at its next node.
+*/
+
+/* A node whose remaining moves are searched by several threads. Lives on the stack of the thread that split. */
+struct SplitPoint
+{
+	SplitPoint(const Bitboard &splitBoard, const MoveList &splitMoves, int firstMove, int splitDepth,
+		int splitAlpha, int splitBeta, int value, U16 move, bool root, SplitPoint *parentSplit) :
+		board(splitBoard),
+		moves(splitMoves),
+		nextMove(firstMove),
+		depth(splitDepth),
+		alpha(splitAlpha),
+		beta(splitBeta),
+		bestValue(value),
+		bestMove(move),
+		isRoot(root),
+		parent(parentSplit),
+		cutoff(false),
+		slaves(0) {}
+
+	const Bitboard board;
+	const MoveList moves;
+	int nextMove;					// Index of the next move to search, under lock
+
+	const int depth;
+	int alpha;						// Raised by any thread, under lock
+	const int beta;
+	int bestValue;					// Under lock
+	U16 bestMove;					// Under lock
+	const bool isRoot;
+
+	SplitPoint *const parent;		// The split point the splitting thread was working on, if any
+
+	std::atomic<bool> cutoff;		// A move failed high, the other moves are not needed
+	std::atomic<int> slaves;		// Number of booked threads that are still working
+	std::mutex lock;
+	std::condition_variable finished;	// Signaled when the last booked thread leaves
+
+	/*
+	Called by a booked thread when it's done. The split point may be gone once this returns:
+	the thread that split only sees the last slave leave after the lock is released.
+	*/
+	void Leave()
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (--slaves == 0)
+			finished.notify_one();
+	}
+
+	/* Called by the thread that split once its own moves are done, sleeps until every booked thread left. */
+	void WaitForSlaves()
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		finished.wait(guard, [this]() { return slaves == 0; });
+	}
+
+	/* Returns true if this split point or one above it was cut off. */
+	bool IsCutOff() const
+	{
+		for (const SplitPoint *sp = this; sp; sp = sp->parent)
+			if (sp->cutoff.load(std::memory_order_relaxed))
+				return true;
+		return false;
+	}
+};
+
+class SearchThreadPool;
+
+/* The state of one search thread. */
+struct SearchThread
+{
+	SearchThread(SearchThreadPool *threadPool, bool isIdle = false) :
+		pool(threadPool), idle(isIdle), work(nullptr), activeSplit(nullptr) {}
+
+	SearchThreadPool *const pool;			// The helpers this thread may book when it splits
+
+	std::atomic<bool> idle;					// Waiting for work, may be booked by a split point
+	std::atomic<SplitPoint *> work;			// Set when booked, the split point to help with
+	SplitPoint *activeSplit;				// The innermost split point this thread is working on
+
+	SearchStats stats;						// Counted by this thread only, collected after the search
+
+	std::mutex sleepLock;
+	std::condition_variable wakeUp;			// Signaled when the thread is booked or the search ends
+
+	/* Returns true if the work of this thread was cut off by another thread. */
+	inline bool IsCutOff() const { return activeSplit && activeSplit->IsCutOff(); }
+
+	/* Wake the thread if it sleeps waiting for work. Taking the lock makes sure it isn't between its check and its wait. */
+	void Wake()
+	{
+		{ std::lock_guard<std::mutex> guard(sleepLock); }
+		wakeUp.notify_one();
+	}
+};
+
+/*
+The helper threads of a player, which split points may book.
+Threads are created on the first search and kept until the pool is destroyed, so short searches don't pay for starting threads.
+Between searches they sleep. During a search an idle helper spins a little for the next booking, then sleeps until it's booked.
+Copying a pool copies nothing, the copy creates its own threads when it is first used.
+*/
+class SearchThreadPool
+{
+public:
+
+	/* The work of a booked helper, searching moves of a split point */
+	typedef std::function<void(SearchThread &, SplitPoint &)> SplitPointWork;
+
+	SearchThreadPool() : m_bSearching(false), m_bSpinWhileIdle(true), m_bQuit(false), m_ParkedCount(0) {}
+	SearchThreadPool(const SearchThreadPool &) : SearchThreadPool() {}
+	SearchThreadPool &operator=(const SearchThreadPool &) { return *this; }
+
+	~SearchThreadPool() { StopThreads(); }
+
+	/*
+	Wake the helpers for a search, creating or recreating the threads if their number changed.
+	Without spinWhileIdle, idle helpers sleep at once instead of spinning for a booking first.
+	Not thread safe, called by the searching thread before it searches.
+	*/
+	void BeginSearch(int helperCount, const SplitPointWork &work, bool spinWhileIdle = true);
+
+	/* Put the helpers back to sleep. Every split point must be finished. */
+	void EndSearch();
+
+	/* Add the counters of every helper to stats and clear them. Called after EndSearch. */
+	void CollectStats(SearchStats &stats)
+	{
+		for (std::unique_ptr<SearchThread> &helper : m_Helpers)
+		{
+			stats.Add(helper->stats);
+			helper->stats.Clear();
+		}
+	}
+
+	inline int GetHelperCount() const { return (int)m_Helpers.size(); }
+
+	/* Returns true if some helper is waiting for work. */
+	bool HasIdleHelper() const
+	{
+		for (const std::unique_ptr<SearchThread> &helper : m_Helpers)
+			if (helper->idle.load(std::memory_order_relaxed))
+				return true;
+		return false;
+	}
+
+	/* Give the split point to every idle helper, returns the number of helpers booked. */
+	int BookHelpers(SplitPoint &sp)
+	{
+		int booked = 0;
+		for (std::unique_ptr<SearchThread> &helper : m_Helpers)
+		{
+			bool expected = true;
+			if (helper->idle.compare_exchange_strong(expected, false))
+			{
+				sp.slaves++;
+				helper->work = &sp;
+				helper->Wake();
+				booked++;
+			}
+		}
+		return booked;
+	}
+
+private:
+
+	/* Number of times an idle helper yields while waiting for a booking before it sleeps */
+	static const int IDLE_SPINS = 256;
+
+	/* Run by every helper thread, sleeps between searches and waits for bookings during a search */
+	void HelperLoop(SearchThread *helper);
+
+	/* Stop and join all helper threads */
+	void StopThreads();
+
+	std::vector<std::unique_ptr<SearchThread>> m_Helpers;
+	std::vector<std::thread> m_Threads;
+	SplitPointWork m_Work;
+
+	std::atomic<bool> m_bSearching;
+	bool m_bSpinWhileIdle;
+	bool m_bQuit;
+	size_t m_ParkedCount;					// Helpers sleeping between searches
+
+	std::mutex m_Mutex;
+	std::condition_variable m_WakeUp;		// Signaled when a search starts or the pool stops
+	std::condition_variable m_Parked;		// Signaled when a helper goes to sleep
+};
+
+/*
+Threads that all run the same work, each on its own (the shared tree of PlayerMCTS), with no split points.
+Created once and kept asleep between runs, so a move doesn't pay for starting threads.
+Copying the threads copies their number only, the copy creates its own threads.
+*/
+class WorkerThreads
+{
+public:
+
+	/* The work of every thread, called with the index of the thread. 0 is the thread that calls Run */
+	typedef std::function<void(int)> Work;
+
+	WorkerThreads(int helperCount = 0) : m_Work(nullptr), m_Run(0), m_Running(0), m_bQuit(false) { Start(helperCount); }
+	WorkerThreads(const WorkerThreads &other) : WorkerThreads(other.GetHelperCount()) {}
+	WorkerThreads &operator=(const WorkerThreads &other);
+
+	~WorkerThreads() { StopThreads(); }
+
+	/* Run the work on the calling thread and on every helper, and return when all of them are done. */
+	void Run(const Work &work);
+
+	inline int GetHelperCount() const { return (int)m_Threads.size(); }
+
+private:
+
+	/* Create the helper threads, there must be none */
+	void Start(int helperCount);
+
+	/* Run by every helper thread, sleeps until Run is called */
+	void ThreadLoop(int threadIndex, unsigned run);
+
+	/* Stop and join all helper threads */
+	void StopThreads();
+
+	std::vector<std::thread> m_Threads;
+	const Work *m_Work;						// The work of the current run, under lock
+
+	unsigned m_Run;							// Number of runs started, helpers start when it changes
+	int m_Running;							// Helpers still working on the current run
+	bool m_bQuit;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_Started;		// Signaled when a run starts or the threads stop
+	std::condition_variable m_Finished;		// Signaled when the last helper finished its work
+};
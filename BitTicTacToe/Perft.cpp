@@ -0,0 +1,162 @@
+#include "Perft.h"
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <vector>
+
+using namespace std;
+
+/* Known-correct counts from the empty board with X to move, checked with an independent brute force. */
+struct PerftKnownCount
+{
+	int depth;
+	U64 nodes;
+	U64 leaves;
+	U64 terminals;
+};
+
+static const PerftKnownCount knownCounts[] =
+{
+	{ 1, 16ULL,			16ULL,			0ULL },
+	{ 2, 256ULL,		240ULL,			0ULL },
+	{ 3, 3616ULL,		3360ULL,		0ULL },
+	{ 4, 47296ULL,		43680ULL,		0ULL },
+	{ 5, 571456ULL,		524160ULL,		0ULL },
+	{ 6, 6337216ULL,	5765760ULL,		0ULL },
+	{ 7, 63994816ULL,	57657600ULL,	316800ULL },
+	{ 8, 580062016ULL,	516067200ULL,	3153024ULL },
+	{ 9, 4685909824ULL,	4105847808ULL,	93912192ULL },
+};
+
+static const int KNOWN_DEPTHS = sizeof(knownCounts) / sizeof(knownCounts[0]);
+
+void Perft::Count(const Bitboard &board, int depth, PerftResult &result)
+{
+	MoveList moves;
+	board.GetAvailableMoves(moves);
+	for (int index = 0; index < moves.count; index++)
+	{
+		Bitboard child = board.DoMoveUnchecked(moves.moves[index]);
+		result.nodes++;
+		if (depth == 1)
+			result.leaves++;
+
+		if (child.GetWinner() != GameTag::Result_None)
+			result.terminals++;				// Finished games have no moves
+		else if (depth > 1)
+			Count(child, depth - 1, result);
+	}
+}
+
+PerftResult Perft::Run(Bitboard board, int depth)
+{
+	auto start = chrono::high_resolution_clock::now();
+
+	PerftResult result;
+	if (depth > 0 && board.GetWinner() == GameTag::Result_None)
+		Count(board, depth, result);
+
+	chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+	result.milliseconds = elapsed.count();
+	return result;
+}
+
+PerftResult Perft::RunParallel(Bitboard board, int depth, int numberOfThreads)
+{
+	// Shallow trees aren't worth splitting
+	if (numberOfThreads < 2 || depth < 3)
+		return Run(board, depth);
+
+	auto start = chrono::high_resolution_clock::now();
+
+	/* Count the first two plies here, and collect the boards at ply 2 as tasks for the threads */
+	PerftResult result;
+	vector<Bitboard> tasks;
+	if (board.GetWinner() == GameTag::Result_None)
+	{
+		MoveList moves;
+		board.GetAvailableMoves(moves);
+		for (int index = 0; index < moves.count; index++)
+		{
+			Bitboard child = board.DoMoveUnchecked(moves.moves[index]);
+			result.nodes++;
+			if (child.GetWinner() != GameTag::Result_None)
+			{
+				result.terminals++;
+				continue;
+			}
+
+			MoveList replies;
+			child.GetAvailableMoves(replies);
+			for (int reply = 0; reply < replies.count; reply++)
+			{
+				Bitboard grandchild = child.DoMoveUnchecked(replies.moves[reply]);
+				result.nodes++;
+				if (grandchild.GetWinner() != GameTag::Result_None)
+					result.terminals++;
+				else
+					tasks.push_back(grandchild);
+			}
+		}
+	}
+
+	// Every thread counts into its own result, they are added up at the end
+	atomic<size_t> nextTask(0);
+	auto worker = [&]() -> PerftResult
+	{
+		PerftResult local;
+		for (size_t index = nextTask++; index < tasks.size(); index = nextTask++)
+			Count(tasks[index], depth - 2, local);
+		return local;
+	};
+
+	vector<future<PerftResult>> futures;
+	for (int thread = 1; thread < numberOfThreads; thread++)
+		futures.push_back(async(launch::async, worker));
+	vector<PerftResult> partials(1, worker());
+	for (future<PerftResult> &f : futures)
+		partials.push_back(f.get());
+
+	for (const PerftResult &partial : partials)
+	{
+		result.nodes += partial.nodes;
+		result.leaves += partial.leaves;
+		result.terminals += partial.terminals;
+	}
+
+	chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+	result.milliseconds = elapsed.count();
+	return result;
+}
+
+/* Prints one line of the benchmark and returns true if the counts match the known ones */
+static bool ReportPerft(const char *name, int depth, const PerftResult &result)
+{
+	double nodesPerSecond = (result.milliseconds > 0) ? result.nodes * 1000.0 / result.milliseconds : 0;
+	printf("%-9s depth %i: %12llu nodes %12llu leaves %10llu terminals %10.1f ms %8.2f Mnodes/s",
+		name, depth, (unsigned long long)result.nodes, (unsigned long long)result.leaves, (unsigned long long)result.terminals, result.milliseconds, nodesPerSecond / 1e6);
+
+	if (depth > KNOWN_DEPTHS)
+	{
+		printf("\n");
+		return true;
+	}
+
+	const PerftKnownCount &known = knownCounts[depth - 1];
+	bool match = result.nodes == known.nodes && result.leaves == known.leaves && result.terminals == known.terminals;
+	printf("  %s\n", match ? "ok" : "MISMATCH");
+	return match;
+}
+
+bool Perft::RunBenchmark(int maxDepth, int numberOfThreads)
+{
+	bool allMatch = true;
+	for (int depth = 1; depth <= maxDepth; depth++)
+	{
+		allMatch &= ReportPerft("Single", depth, Run(Bitboard(), depth));
+		allMatch &= ReportPerft("Parallel", depth, RunParallel(Bitboard(), depth, numberOfThreads));
+	}
+	printf(allMatch ? "All counts match.\n" : "Some counts don't match the known values!\n");
+	return allMatch;
+}
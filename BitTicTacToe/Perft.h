@@ -0,0 +1,41 @@
+#pragma once
+#include "Bitboard.h"
+
+/* Node counts of a move generation tree, see Perft. */
+struct PerftResult
+{
+	U64 nodes;			// Boards reached at every depth
+	U64 leaves;			// Boards reached at the last depth
+	U64 terminals;		// Boards where the game ended (win or draw), at any depth
+	double milliseconds;
+
+	PerftResult() : nodes(0), leaves(0), terminals(0), milliseconds(0) {}
+};
+
+/*
+Performance test of move generation: walks the complete tree of moves to a fixed depth
+and counts the boards reached. Finished games are counted and not expanded.
+The counts only depend on the rules, so any change to Bitboard must keep them intact,
+and the time taken is the raw throughput of GetAvailableMoves/DoMove/GetWinner.
+*/
+class Perft
+{
+public:
+
+	/* Count the tree of a board using one thread. */
+	static PerftResult Run(Bitboard board, int depth);
+
+	/* Count the tree of a board using a number of threads. */
+	static PerftResult RunParallel(Bitboard board, int depth, int numberOfThreads);
+
+	/*
+	Run both versions from the empty board for depths 1 to maxDepth, print the counts and nodes/sec,
+	and compare them with the known-correct counts. Returns true if all counts match.
+	*/
+	static bool RunBenchmark(int maxDepth, int numberOfThreads);
+
+private:
+
+	/* The recursive count, adds to the result */
+	static void Count(const Bitboard &board, int depth, PerftResult &result);
+};
@@ -1,5 +1,8 @@
 #pragma once
 #include "Bitboard.h"
+#include <chrono>
+
+class MoveRequest;
 
 class Player
 {
@@ -13,8 +16,54 @@ public:
 	*/
 	virtual U16 GetMove(Bitboard board) { return 0; }
 
+	/*
+	Search for a move on another thread, and return the request at once (see MoveRequest.h).
+	With a deadline, waiting for the move stops the search when it passes.
+	*/
+	MoveRequest GetMoveAsync(Bitboard board);
+	MoveRequest GetMoveAsync(Bitboard board, std::chrono::steady_clock::time_point deadline);
+
+	/*
+	Ask a running GetMove to return its best move so far as soon as it can. Thread safe.
+	Players that can't stop ignore it, it has no effect on a GetMove started later.
+	*/
+	virtual void StopSearch() {}
+
+	/*
+	Called by GetMoveAsync before its thread starts: the next GetMove belongs to a request,
+	returns the number StopRequest stops it with. 0 if the player doesn't number its searches.
+	*/
+	virtual unsigned ReserveSearch() { return 0; }
+
+	/*
+	Stop the GetMove of a request, even if it didn't start yet. A request that is already done is ignored,
+	so a late stop doesn't cut a later search short. Thread safe. Without numbered searches, this is StopSearch.
+	*/
+	virtual void StopRequest(unsigned request) { StopSearch(); }
+
+	/* Returns the best move found so far by a running GetMove, 0 if there is none yet. Thread safe. */
+	virtual U16 GetBestMoveSoFar() { return 0; }
+
 	GameTag GetPlayerTag() { return m_PlayerTag; }
 
+	/*
+	Called by the game managers before the first move of every game.
+	Players that keep results between moves drop them here.
+	*/
+	virtual void NewGame() {}
+
+	/*
+	Called by the game manager after this player's move, with the board the other player has to move on.
+	Players may think in the background (ponder) until StopPondering is called.
+	*/
+	virtual void StartPondering(Bitboard board) {}
+
+	/*
+	Called when the other player returned its move, or with 0 if the game ended or was aborted.
+	Any background search must be stopped before returning.
+	*/
+	virtual void StopPondering(U16 otherMove) {}
+
 protected:
 
 	/* Default constructor, not meant to be called. */
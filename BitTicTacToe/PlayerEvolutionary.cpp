@@ -5,13 +5,14 @@
 
 int PlayerEvolutionary::GetStaticValue(Bitboard &board)
 {
-	svCount++;
+	int value = PlayerMinimax::GetStaticValue(board);
+	if (value != 0)
+		return value;
+	if (board.GetWinner() == GameTag::Result_Draw)
+		return GetDrawValue();
 
-	if (PlayerMinimax::GetStaticValue(board) != 0)
-		return PlayerMinimax::GetStaticValue(board);
-
-	double value = m_Net.FeedForward(board.EncodeBoardDVec(m_PlayerTag))[0];
-	return (int)(value * 1000000000);	// value * 1B, for maximum precision
+	double netValue = m_Net.FeedForward(board.EncodeBoardDVec(m_PlayerTag))[0];
+	return (int)(netValue * 1000000000);	// value * 1B, for maximum precision
 }
 
 void PlayerEvolutionary::LoadPlayer(std::ifstream &in)
@@ -2,6 +2,18 @@
 #include "PlayerMinimax.h"
 #include "NeuralNet.h"
 
+/*
+Transposition table size of evolution players, 2^12 slots (64KB). Their shallow searches don't fill more,
+and a population holds many players, each with its own table.
+*/
+const int EVOLUTION_TABLE_SIZE_LOG2 = 12;
+
+/*
+Static value of a draw for evolution players. The network's output (0 to 1) is scaled to 0 to 1B,
+so draws get the value of an output of 0.5, an even board, and not the 0 of a lost one.
+*/
+const int EVOLUTION_DRAW_VALUE = 500000000;
+
 class PlayerEvolutionary :
 	public PlayerMinimax
 {
@@ -13,13 +25,17 @@ public:
 		int depth = 9, 
 		int maxNumberOfThreads = 4, 
 		bool verbose = false, 
-		bool powerSave = false
+		bool powerSave = false,
+		int tableSizeLog2 = EVOLUTION_TABLE_SIZE_LOG2
 		) :
 		PlayerMinimax(tag, depth, false, maxNumberOfThreads, verbose, powerSave),
 		m_Net(NeuralNet(std::vector<size_t>({ 16, 32, 8, 1 }))),
 		m_FitnessValue(0),
 		m_GamesPlayed(0)
-	{}
+	{
+		SetTranspositionTable(tableSizeLog2);
+		SetEndgameThreshold(ENDGAME_THRESHOLD);
+	}
 
 	// New player with given network
 	PlayerEvolutionary(
@@ -27,13 +43,17 @@ public:
 		GameTag tag = GameTag::Player_X, 
 		int depth = 9, int maxNumberOfThreads = 4, 
 		bool verbose = false, 
-		bool powerSave = true
+		bool powerSave = true,
+		int tableSizeLog2 = EVOLUTION_TABLE_SIZE_LOG2
 		) :
 		PlayerMinimax(tag, depth, false, maxNumberOfThreads, verbose, powerSave),
 		m_Net(net),
 		m_FitnessValue(0),
 		m_GamesPlayed(0)
-	{}
+	{
+		SetTranspositionTable(tableSizeLog2);
+		SetEndgameThreshold(ENDGAME_THRESHOLD);
+	}
 
 	~PlayerEvolutionary(){}
 
@@ -58,6 +78,12 @@ private:
 	// NN feedforward output for a board as input
 	virtual int GetStaticValue(Bitboard &board) final;
 
+	// The network may value symmetric boards differently
+	virtual bool HasSymmetricEvaluation() final { return false; }
+
+	// Draws aren't left to the network, so the endgame solver and the search agree on them
+	virtual int GetDrawValue() const final { return EVOLUTION_DRAW_VALUE; }
+
 	NeuralNet m_Net;
 	
 	int m_FitnessValue;
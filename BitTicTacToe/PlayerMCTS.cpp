@@ -0,0 +1,263 @@
+#include "PlayerMCTS.h"
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+
+using namespace std;
+
+// Result of a win, a draw is half of it. Network values are scaled to it
+static const long long MCTS_SCORE_WIN = 1000;
+
+// The clock is checked once every this many iterations of a thread
+static const int MCTS_CLOCK_INTERVAL = 64;
+
+/* Xorshift, a fast random number generator with 32 bits of state. The state must not be 0 */
+static inline U32 NextRandom(U32 &state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+/* Returns one of the set bits of a moves mask, chosen at random */
+static inline U16 RandomMove(U16 moves, U32 &random)
+{
+	for (int skip = NextRandom(random) % CountBitsU16(moves); skip > 0; skip--)
+		Bitboard::PopMove(moves);
+	return Bitboard::PopMove(moves);
+}
+
+MCTSArena &MCTSArena::operator=(const MCTSArena &other)
+{
+	if (this != &other)
+	{
+		// Only the capacity is copied, see the class description
+		m_Capacity = other.m_Capacity;
+		m_Used = 0;
+		m_Nodes.reset();
+	}
+	return *this;
+}
+
+void MCTSArena::Reset()
+{
+	if (!m_Nodes)
+		m_Nodes.reset(new MCTSNode[m_Capacity]);
+
+	MCTSNode &root = m_Nodes[0];
+	root.move = 0;
+	root.childCount = 0;
+	root.firstChild = 0;
+	root.state = MCTS_UNEXPANDED;
+	root.visits = 0;
+	root.score = 0;
+	m_Used = 1;
+}
+
+U32 MCTSArena::Allocate(U32 count)
+{
+	U32 used = m_Used.load(memory_order_relaxed);
+	do
+	{
+		if (used + count > m_Capacity)
+			return 0;
+	} while (!m_Used.compare_exchange_weak(used, used + count, memory_order_relaxed));
+	return used;
+}
+
+U16 PlayerMCTS::GetMove(Bitboard board)
+{
+	auto start = chrono::high_resolution_clock::now();
+
+	m_Arena.Reset();
+	m_IterationCount = 0;
+	m_MoveCount++;
+
+	m_SearchStop.Begin();
+	if (m_TimeLimit > 0)
+		m_SearchStop.SetDeadline(m_TimeLimit);
+
+	// The additional threads search the same tree as this one
+	m_Helpers.Run([this, &board](int threadIndex) { SearchWorker(board, threadIndex); });
+
+	/* Play the most visited move, its average is the most reliable */
+	MCTSNode &root = m_Arena[0];
+	if (root.state.load(memory_order_acquire) != MCTS_EXPANDED)
+	{
+		MoveList moves;
+		board.GetAvailableMoves(moves);
+		return moves.moves[0];
+	}
+
+	MCTSNode *best = &m_Arena[root.firstChild];
+	for (U32 index = 1; index < root.childCount; index++)
+	{
+		MCTSNode &child = m_Arena[root.firstChild + index];
+		if (child.visits > best->visits)
+			best = &child;
+	}
+
+	if (m_Verbose)
+	{
+		chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+		double average = (best->visits > 0) ? (double)best->score / ((double)best->visits * MCTS_SCORE_WIN) : 0;
+		printf("\naverage result: %.3f | visits: %i/%i | tree nodes: %u | %.1f ms\n",
+			average, best->visits.load(), root.visits.load(), m_Arena.GetUsed(), elapsed.count());
+	}
+
+	return best->move;
+}
+
+void PlayerMCTS::SearchWorker(const Bitboard &board, int threadIndex)
+{
+	// Different seeds for every thread and move, never 0
+	U32 random = (m_MoveCount * 0x9E3779B9u) ^ ((U32)threadIndex * 0x85EBCA6Bu) ^ 0x2545F491u;
+	if (random == 0)
+		random = 1;
+
+	for (int iteration = 0; ; iteration++)
+	{
+		if (m_TimeLimit > 0)
+		{
+			if (iteration % MCTS_CLOCK_INTERVAL == 0 && m_SearchStop.CheckDeadline())
+				break;
+		}
+		else if (m_IterationCount++ >= m_Iterations || m_SearchStop.IsStopped())
+			break;
+
+		RunIteration(board, random);
+	}
+}
+
+void PlayerMCTS::RunIteration(const Bitboard &rootBoard, U32 &random)
+{
+	/*
+	Walk down the tree, counting a visit to every node on the way (the virtual loss).
+	Stop at a finished game, a node that can't be expanded yet, or a node visited for the first time.
+	*/
+	U32 path[17];
+	GameTag movers[17];			// The player who made the move into each node of the path
+	int length = 0;
+
+	Bitboard board = rootBoard;
+	U32 nodeIndex = 0;
+	m_Arena[0].visits++;
+
+	while (board.GetWinner() == GameTag::Result_None)
+	{
+		MCTSNode &node = m_Arena[nodeIndex];
+		if (node.state.load(memory_order_acquire) != MCTS_EXPANDED && !Expand(node, board))
+			break;
+
+		nodeIndex = SelectChild(node);
+		MCTSNode &child = m_Arena[nodeIndex];
+		movers[length] = board.GetPlayerTag();
+		path[length++] = nodeIndex;
+		board = board.DoMoveUnchecked(child.move);
+
+		if (child.visits++ == 0)
+			break;
+	}
+
+	/* Back up the result, each node gets it for the player who moved into it */
+	long long score = Evaluate(board, random);
+	for (int index = 0; index < length; index++)
+		m_Arena[path[index]].score += (movers[index] == GameTag::Player_X) ? score : MCTS_SCORE_WIN - score;
+}
+
+bool PlayerMCTS::Expand(MCTSNode &node, const Bitboard &board)
+{
+	U8 expected = MCTS_UNEXPANDED;
+	if (!node.state.compare_exchange_strong(expected, MCTS_EXPANDING))
+		return false;
+
+	MoveList moves;
+	board.GetAvailableMoves(moves);
+	U32 first = m_Arena.Allocate(moves.count);
+	if (first == 0)
+	{
+		// The arena is full, the node stays a leaf
+		node.state.store(MCTS_UNEXPANDED, memory_order_relaxed);
+		return false;
+	}
+
+	for (int index = 0; index < moves.count; index++)
+	{
+		MCTSNode &child = m_Arena[first + index];
+		child.move = moves.moves[index];
+		child.childCount = 0;
+		child.firstChild = 0;
+		child.state.store(MCTS_UNEXPANDED, memory_order_relaxed);
+		child.visits.store(0, memory_order_relaxed);
+		child.score.store(0, memory_order_relaxed);
+	}
+	node.firstChild = first;
+	node.childCount = (U8)moves.count;
+	node.state.store(MCTS_EXPANDED, memory_order_release);		// The children are visible to other threads from now
+	return true;
+}
+
+U32 PlayerMCTS::SelectChild(const MCTSNode &node)
+{
+	int parentVisits = node.visits.load(memory_order_relaxed);
+	double logVisits = log((double)((parentVisits > 1) ? parentVisits : 1));
+
+	U32 best = node.firstChild;
+	double bestBound = -1;
+	for (U32 index = node.firstChild; index < node.firstChild + node.childCount; index++)
+	{
+		const MCTSNode &child = m_Arena[index];
+		int visits = child.visits.load(memory_order_relaxed);
+		if (visits == 0)
+			return index;			// Every move is tried once before any is tried twice
+
+		double average = (double)child.score.load(memory_order_relaxed) / ((double)visits * MCTS_SCORE_WIN);
+		double bound = average + m_Exploration * sqrt(logVisits / visits);
+		if (bound > bestBound)
+		{
+			bestBound = bound;
+			best = index;
+		}
+	}
+	return best;
+}
+
+long long PlayerMCTS::Evaluate(const Bitboard &board, U32 &random)
+{
+	GameTag winner = board.GetWinner();
+	if (winner == GameTag::Result_None && m_ValueNet)
+	{
+		Bitboard leaf = board;
+		dVector input = leaf.EncodeBoardDVec(GameTag::Player_X);
+		double value = m_ValueNet->FeedForward(input)[1];		// Element 0 of every layer's output is the bias input
+		if (value < 0) value = 0;
+		if (value > 1) value = 1;
+		return (long long)(value * MCTS_SCORE_WIN);
+	}
+
+	if (winner == GameTag::Result_None)
+		winner = Rollout(board, random);
+
+	if (winner == GameTag::Player_X)
+		return MCTS_SCORE_WIN;
+	if (winner == GameTag::Result_Draw)
+		return MCTS_SCORE_WIN / 2;
+	return 0;
+}
+
+GameTag PlayerMCTS::Rollout(Bitboard board, U32 &random)
+{
+	/* Random moves alone miss wins and blocks that any player sees, which makes the results noisy */
+	while (board.GetWinner() == GameTag::Result_None)
+	{
+		U16 moves = board.GetWinningSquares(board.GetPlayerTag());
+		if (!moves)
+			moves = board.GetWinningSquares(board.GetOtherPlayerTag());
+		if (!moves)
+			moves = board.GetAvailableMovesMask();
+
+		board = board.DoMoveUnchecked(RandomMove(moves, random));
+	}
+	return board.GetWinner();
+}
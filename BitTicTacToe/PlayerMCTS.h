@@ -0,0 +1,173 @@
+#pragma once
+#include "Player.h"
+#include "SearchStop.h"
+#include "ParallelSearch.h"
+#include "NeuralNet.h"
+#include <atomic>
+#include <memory>
+
+/* A node of the search tree, reached by a move from its parent. Shared by all search threads. */
+struct MCTSNode
+{
+	U16 move;
+	U8 childCount;
+	std::atomic<U8> state;			// See MCTSNodeState
+	U32 firstChild;					// Index of the first child in the arena, the children are consecutive
+
+	std::atomic<int> visits;		// Includes the searches still running below this node (virtual loss)
+	std::atomic<long long> score;	// Sum of results for the player who made the move, MCTS_SCORE_WIN for a win
+};
+
+/* Expansion state of a node. The children of a node may be used only once it's Expanded. */
+enum MCTSNodeState : U8
+{
+	MCTS_UNEXPANDED,
+	MCTS_EXPANDING,					// One thread is creating the children
+	MCTS_EXPANDED
+};
+
+/*
+A fixed block of nodes, allocated once and handed out in runs of consecutive nodes without locks.
+Resetting it frees every node at once, there is no per-node deallocation.
+Copying an arena copies its capacity only, the copy allocates its own nodes when it is first used.
+*/
+class MCTSArena
+{
+public:
+
+	MCTSArena(U32 capacity = 1 << 20) : m_Capacity(capacity), m_Used(0) {}
+	MCTSArena(const MCTSArena &other) : MCTSArena(other.m_Capacity) {}
+	MCTSArena &operator=(const MCTSArena &other);
+
+	~MCTSArena() {}
+
+	/* Free all nodes, allocating the memory on first use, and create the root node (index 0). */
+	void Reset();
+
+	/* Returns the index of the first of count new nodes, or 0 if the arena is full. Thread safe. */
+	U32 Allocate(U32 count);
+
+	inline MCTSNode &operator[](U32 index) { return m_Nodes[index]; }
+
+	inline U32 GetUsed() const { return m_Used.load(std::memory_order_relaxed); }
+
+private:
+
+	std::unique_ptr<MCTSNode[]> m_Nodes;
+	U32 m_Capacity;
+	std::atomic<U32> m_Used;
+};
+
+/*
+MONTE CARLO TREE SEARCH (UCT, tree parallel)
+
+	Every iteration walks down the tree from the root, choosing the child with the best
+	upper confidence bound (UCB1): average result + C * sqrt(ln(parent visits) / child visits).
+	At the first unvisited node the board is evaluated, by playing it out with a simple policy
+	(win if possible, block if needed, otherwise a random move) or by a neural network,
+	and the result is added to every node on the way back up.
+	The move played is the root child with the most visits.
+
+	All threads search the same tree. A thread counts its visit to a node when it passes it, and its result
+	only when it returns, so until then the node looks like a loss (virtual loss) and other threads spread
+	to other moves. Nodes are created in an arena, a full arena stops the tree from growing but not the search.
+*/
+class PlayerMCTS :
+	public Player
+{
+public:
+
+	PlayerMCTS(
+		GameTag tag = GameTag::Player_X,
+		int iterations = 20000,
+		int maxNumberOfThreads = 4,
+		bool verbose = true
+		) :
+		Player(tag),
+		m_Iterations(iterations),
+		m_TimeLimit(0),
+		m_NumberOfThreads(maxNumberOfThreads),
+		m_Verbose(verbose),
+		m_Exploration(1.4),
+		m_Helpers(maxNumberOfThreads - 1),
+		m_MoveCount(0) {}
+
+	~PlayerMCTS() {}
+
+	virtual U16 GetMove(Bitboard board) final;
+
+	/* Make a running GetMove stop adding iterations and play the most visited move. */
+	virtual void StopSearch() { m_SearchStop.Stop(); }
+	virtual unsigned ReserveSearch() { return m_SearchStop.Reserve(); }
+	virtual void StopRequest(unsigned request) { m_SearchStop.StopRequest(request); }
+
+	/* Search every move for a number of milliseconds instead of a number of iterations. 0 turns the time limit off. */
+	void SetTimeLimit(int milliseconds) { m_TimeLimit = (milliseconds > 0) ? milliseconds : 0; }
+
+	/* The number of iterations of every move, shared by all threads. */
+	void SetIterations(int iterations) { m_Iterations = (iterations > 0) ? iterations : 1; }
+
+	/* The exploration constant C of UCB1, higher values search less visited moves more. */
+	void SetExploration(double exploration) { m_Exploration = exploration; }
+
+	/* Maximum number of nodes in the tree. */
+	void SetArenaCapacity(U32 capacity) { m_Arena = MCTSArena(capacity); }
+
+	/*
+	Evaluate new nodes with a network (as PlayerEvolutionary does) instead of playing them out.
+	The network's output for a board, encoded for a player, is that player's expected result from 0 to 1.
+	*/
+	void SetValueNetwork(const NeuralNet &net) { m_ValueNet.reset(new NeuralNet(net)); }
+
+private:
+
+	/* The search of one thread, runs iterations until the budget is used */
+	void SearchWorker(const Bitboard &board, int threadIndex);
+
+	/* One iteration: select a path down the tree, expand its last node, evaluate and back up the result */
+	void RunIteration(const Bitboard &board, U32 &random);
+
+	/* Creates the children of a node, returns false if another thread is doing it or the arena is full */
+	bool Expand(MCTSNode &node, const Bitboard &board);
+
+	/* Returns the index of the child with the best upper confidence bound */
+	U32 SelectChild(const MCTSNode &node);
+
+	/* Returns the expected result of a board for player X, from 0 (loss) to MCTS_SCORE_WIN (win) */
+	long long Evaluate(const Bitboard &board, U32 &random);
+
+	/* Plays the game out with the rollout policy and returns the result */
+	GameTag Rollout(Bitboard board, U32 &random);
+
+	// Iterations per move, used when there is no time limit
+	int m_Iterations;
+
+	// Milliseconds per move, 0 to use m_Iterations
+	int m_TimeLimit;
+
+	int m_NumberOfThreads;
+
+	// Should print result
+	bool m_Verbose;
+
+	// The C of UCB1
+	double m_Exploration;
+
+	// Nodes of the current search
+	MCTSArena m_Arena;
+
+	// Iterations started by all threads in the current search
+	std::atomic<int> m_IterationCount;
+
+	// Interrupts the search when the time limit is reached or StopSearch is called
+	SearchStop m_SearchStop;
+
+	// The additional threads, kept between moves
+	WorkerThreads m_Helpers;
+
+	// Evaluates new nodes if set, otherwise they are played out
+	std::shared_ptr<NeuralNet> m_ValueNet;
+
+	// Moves searched so far, seeds the random numbers so every search differs
+	U32 m_MoveCount;
+};
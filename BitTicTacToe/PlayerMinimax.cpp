@@ -1,10 +1,16 @@
 #include "PlayerMinimax.h"
 #include <stdio.h>
+#include <chrono>
 #include <thread>
-#include <future>
 
 const int MINIMAX_INFINITY = 2147483647;
 
+// Value of a win, the number of clear squares left is added so faster wins are better
+const int MINIMAX_WIN = 1000000000;
+
+// Nodes closer to the leaves are searched by one thread, sharing them costs more than it saves
+const int SPLIT_MIN_DEPTH = 4;
+
 template<class T>
 T Max(const T &t1, const T &t2)
 {
@@ -17,77 +23,330 @@ T Min(const T &t1, const T &t2)
 	return (t1 < t2) ? t1 : t2;
 }
 
-template<class T>
-std::vector<T> subvector(const std::vector<T>& vec, size_t first, size_t last)
+U16 PlayerMinimax::GetMove(Bitboard board)
 {
-	std::vector<T> nvec(last - first + 1);
-	for (size_t i = 0; i < (last - first); i++)
-		nvec[i] = vec[first + i];
-	return nvec;
+	// The game manager stops pondering when the other player moves, this covers other callers
+	StopPondering(0);
+	m_Stats.Clear();
+
+	// A reply prepared while the other player was thinking
+	for (const PreparedMove &prepared : m_PreparedMoves)
+		if (prepared.xBoard == board.GetXBoard() && prepared.oBoard == board.GetOBoard())
+		{
+			m_Stats.depth = prepared.depth;
+			if (m_Verbose)
+				printf("\nvalue: %i | depth: %i | pondered\n", prepared.value, prepared.depth);
+			U16 move = prepared.move;
+			m_PreparedMoves.clear();
+			return move;
+		}
+	m_PreparedMoves.clear();
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// The best move stays readable once the search is done, until the next one begins
+	m_SearchStop.Begin();
+	m_SearchStats.Clear();
+	int completedDepth;
+	MinimaxMove bestMove = SearchBoard(board, completedDepth);
+
+	// Copied, so pondering after this move doesn't change them
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	m_Stats = m_SearchStats;
+	m_Stats.depth = completedDepth;
+	m_Stats.milliseconds = elapsed.count();
+
+	if (m_Verbose)
+	{
+		U64 cutoffs = m_Stats.GetCutoffs();
+		U64 probes = m_Stats.tableProbes;
+		printf("\nvalue: %i | depth: %i | nodes: %llu | %.0f nodes/s | %.1f ms\n",
+			bestMove.value, m_Stats.depth, (unsigned long long)m_Stats.nodes, m_Stats.GetNodesPerSecond(), m_Stats.milliseconds);
+		printf("branching factor: %.2f | static evaluations: %llu | quiescence nodes: %llu | endgame nodes: %llu | table hits: %.1f%% | first move cutoffs: %.1f%% | max ply: %i\n",
+			m_Stats.GetBranchingFactor(), (unsigned long long)m_Stats.staticEvaluations,
+			(unsigned long long)m_Stats.quiescenceNodes, (unsigned long long)m_Stats.endgameNodes,
+			probes ? 100.0 * m_Stats.tableHits / probes : 0.0,
+			cutoffs ? 100.0 * m_Stats.cutoffs[0] / cutoffs : 0.0, m_Stats.maxPly);
+	}
+
+	return bestMove.index;
 }
 
-U16 PlayerMinimax::GetMove(Bitboard board)
+MinimaxMove PlayerMinimax::SearchBoard(Bitboard board, int &completedDepth)
 {
 	using namespace std;
 
-	// Reset static evaluations count
-	svCount = 0;
+	// The time limit counts from here, preparing the search is part of the move
+	SearchStop::Clock::time_point searchStart = SearchStop::Clock::now();
+
+	// Results of previous moves of the game are reused, see NewGame
+	m_TranspositionTable.NewSearch();
+	m_MoveOrdering.NewSearch();
+	m_bSymmetricKeys = HasSymmetricEvaluation();
 
 	// Get all the next moves for the board
-	U16 *nextMoves = board.GetAvailableMoves();
-	int   moveCount = board.GetClearBitsCount();
+	MoveList nextMoves;
+	board.GetAvailableMoves(nextMoves);
 
-	// Convert C-style array to vector
-	vector<U16> nextMovesVec(moveCount);
-	for (int i = 0; i < moveCount; i++)
-		nextMovesVec[i] = nextMoves[i];
+	// The best move of an earlier search of this board, usually part of the previous move's principal variation, goes first
+	int transform = 0;
+	TTEntry entry;
+	if (m_TranspositionTable.Probe(GetTableKey(board, transform), entry) && entry.move)
+	{
+		U16 hashMove = Bitboard::TransformBoard(entry.move, Bitboard::InverseTransform(transform));
+		for (int moveIndex = 1; moveIndex < nextMoves.count; moveIndex++)
+			if (nextMoves.moves[moveIndex] == hashMove)
+			{
+				for (; moveIndex > 0; moveIndex--)
+					nextMoves.moves[moveIndex] = nextMoves.moves[moveIndex - 1];
+				nextMoves.moves[0] = hashMove;
+				break;
+			}
+	}
 
-	// Find the number of ADDITIONAL threads required (and available).
-	int numberOfThreads = m_NumberOfThreads;
-	if (moveCount < numberOfThreads)	// Don't use more threads than tasks to performe
-		numberOfThreads = moveCount;
+	// Convert to vector
+	vector<U16> nextMovesVec(nextMoves.moves, nextMoves.moves + nextMoves.count);
 
-	vector<vector<int>> dist = DistributeWork(moveCount, numberOfThreads);
+	// Any move is better than none, if the search is stopped at once
+	m_SearchStop.SetBestMove(nextMoves.moves[0]);
 
-	--numberOfThreads;	// We are already using one thread
+	if (nextMoves.count <= m_EndgameThreshold)
+	{
+		completedDepth = nextMoves.count;
+		return SolveEndgame(board);
+	}
 
-	// Save the futures from async to find the best one later
-	vector<future<MinimaxMove>> futures;
+	if (m_TimeLimit == 0 && m_Algorithm == SearchAlgorithm::AlphaBeta)
+	{
+		MinimaxMove bestMove = SearchRoot(board, nextMovesVec, m_SearchDepth, -MINIMAX_INFINITY, MINIMAX_INFINITY);
+		completedDepth = m_SearchStop.IsStopped() ? 0 : m_SearchDepth;
+		return bestMove;
+	}
 
-	// Start additional threads
-	for (int threadNumber = 0; threadNumber < numberOfThreads; ++threadNumber)
+	/*
+	Iterative deepening: search to depth 1, 2, 3... until the time runs out (or to the search depth).
+	Each iteration starts with the best move of the previous one, and the transposition table
+	keeps the best moves of inner boards, so deeper iterations cut off early.
+	The first iteration always completes, so there is always a move to play: its boards are all leaves,
+	and the deadline is only checked at inner boards.
+	*/
+	if (m_TimeLimit > 0)
+		m_SearchStop.SetDeadline(searchStart + chrono::milliseconds(m_TimeLimit));
+
+	MinimaxMove bestMove = SearchRoot(board, nextMovesVec, 1, -MINIMAX_INFINITY, MINIMAX_INFINITY);
+	m_SearchStop.SetBestMove(bestMove.index);
+	completedDepth = 1;
+
+	// Searching past the last clear square gives the same result
+	int maxDepth = board.GetClearBitsCount();
+	if (m_TimeLimit == 0)
+		maxDepth = Min(maxDepth, m_SearchDepth);
+
+	for (int depth = 2; depth <= maxDepth; depth++)
 	{
-		// Start a thread with std::asyc, rather than std::thread
-		futures.push_back(async(
-			launch::async,						// Start a thread and not lazy-evaluation
-			&PlayerMinimax::MinimaxWorker,		// Pass the worker function
-			this,								// Since this is a member function, 
-												// we have to include the hideden pointer this
-			board,
-			subvector<U16>(nextMovesVec,					// Construct the subset vector (worker moves)
-				dist[threadNumber + 1][0],
-				dist[threadNumber + 1][1])
-			));
+		/*
+		A forced win or loss within the completed depth was seen by every move, so deeper iterations find the same.
+		Wins are worth the win value plus the clear squares left, so the game ends after MINIMAX_WIN + clear - value moves.
+		One found past the depth by the quiescence search may not be the shortest, keep searching then.
+		*/
+		int winValue = (bestMove.value >= 0) ? bestMove.value : -bestMove.value;
+		if (winValue >= MINIMAX_WIN && MINIMAX_WIN + board.GetClearBitsCount() - winValue <= completedDepth)
+			break;
+
+		for (size_t moveIndex = 1; moveIndex < nextMovesVec.size(); moveIndex++)
+			if (nextMovesVec[moveIndex] == bestMove.index)
+			{
+				nextMovesVec.erase(nextMovesVec.begin() + moveIndex);
+				nextMovesVec.insert(nextMovesVec.begin(), bestMove.index);
+				break;
+			}
+
+		MinimaxMove move = AspirationSearch(board, nextMovesVec, depth, bestMove.value);
+		if (m_SearchStop.IsStopped())	// Interrupted, the result is incomplete
+			break;
+
+		bestMove = move;
+		m_SearchStop.SetBestMove(bestMove.index);
+		completedDepth = depth;
 	}
 
-	// Let the main thread do part of the work
-	MinimaxMove bestMove = MinimaxWorker(
-		board,
-		subvector<U16>(nextMovesVec, dist[0][0], dist[0][1]));
+	return bestMove;
+}
 
-	// Get moves and find best
-	for (int i = 0; i < numberOfThreads; i++)
+MinimaxMove PlayerMinimax::SolveEndgame(const Bitboard &board)
+{
+	SearchStats stats;
+	stats.nodes = 1;
+
+	MoveList moves;
+	board.GetAvailableMoves(moves);
+	KeepForcedMoves(board, moves.count, moves);
+
+	/* Later moves only have to be proven no better than the best so far, their values are upper bounds */
+	MinimaxMove bestMove;
+	bestMove.index = moves.moves[0];
+	bestMove.value = -MINIMAX_INFINITY;
+	for (int moveIndex = 0; moveIndex < moves.count; moveIndex++)
 	{
-		MinimaxMove move = futures[i].get();
-		if (move.value > bestMove.value)
-			bestMove = move;
+		int value = -EndgameSolver::Solve(board.DoMoveUnchecked(moves.moves[moveIndex]),
+			-MINIMAX_INFINITY, -bestMove.value, MINIMAX_WIN, -GetDrawValue(), stats);
+		if (value > bestMove.value)
+		{
+			bestMove.index = moves.moves[moveIndex];
+			bestMove.value = value;
+			m_SearchStop.SetBestMove(bestMove.index);
+		}
 	}
 
-	if (m_Verbose)
-		printf("\nvalue: %i | static evaluations: %i\n", bestMove.value, svCount);
+	stats.maxPly = moves.count;
+	m_SearchStats.Add(stats);
+	return bestMove;
+}
 
-	delete[] nextMoves;
-	return bestMove.index;
+void PlayerMinimax::NewGame()
+{
+	StopPondering(0);
+	m_PreparedMoves.clear();
+	m_TranspositionTable.NewGame();
+	m_MoveOrdering.Clear();
+}
+
+void PlayerMinimax::StartPondering(Bitboard board)
+{
+	if (!m_bPonder)
+		return;
+
+	StopPondering(0);
+	m_PreparedMoves.clear();
+	m_PonderBoard = board;
+	m_Ponder.Start([this, board]() { Ponder(board); });
+}
+
+void PlayerMinimax::StopPondering(U16 otherMove)
+{
+	if (!m_Ponder.IsRunning())
+		return;
+
+	/*
+	The ponder thread resets the stop before every search and checks the request right after,
+	so setting them in the opposite order here can't be missed.
+	*/
+	m_Ponder.RequestStop();
+	m_SearchStop.Stop();
+	m_Ponder.Join();
+	m_SearchStop.Clear();
+
+	// Only the answer to the move that was played is needed
+	if (otherMove != 0)
+	{
+		Bitboard played = m_PonderBoard.DoMoveUnchecked(otherMove);
+		for (size_t index = 0; index < m_PreparedMoves.size(); index++)
+			if (m_PreparedMoves[index].xBoard == played.GetXBoard() && m_PreparedMoves[index].oBoard == played.GetOBoard())
+			{
+				PreparedMove prepared = m_PreparedMoves[index];
+				m_PreparedMoves.assign(1, prepared);
+				return;
+			}
+		m_PreparedMoves.clear();
+	}
+}
+
+void PlayerMinimax::Ponder(Bitboard board)
+{
+	/*
+	The likely replies come first: the best move of the other player found by the last search,
+	which is still in the transposition table, then the killers and history of that search.
+	Each reply is searched as if it was played, with the same depth or time as a real move,
+	so a prepared answer is as good as the one GetMove would find. Searches cut short are dropped.
+	*/
+	int transform = 0;
+	TTEntry entry;
+	U16 predicted = 0;
+	if (m_TranspositionTable.Probe(GetTableKey(board, transform), entry))
+		predicted = Bitboard::TransformBoard(entry.move, Bitboard::InverseTransform(transform));
+
+	MoveList replies;
+	board.GetAvailableMoves(replies);
+	m_MoveOrdering.OrderMoves(board, replies, predicted);
+
+	for (int replyIndex = 0; replyIndex < replies.count; replyIndex++)
+	{
+		Bitboard reply = board.DoMoveUnchecked(replies.moves[replyIndex]);
+		if (reply.GetWinner() != GameTag::Result_None)
+			continue;
+
+		m_SearchStop.Clear();
+		if (m_Ponder.IsStopRequested())
+			break;
+
+		PreparedMove prepared;
+		MinimaxMove move = SearchBoard(reply, prepared.depth);
+		if (m_Ponder.IsStopRequested())
+			break;
+
+		prepared.xBoard = reply.GetXBoard();
+		prepared.oBoard = reply.GetOBoard();
+		prepared.move = move.index;
+		prepared.value = move.value;
+		m_PreparedMoves.push_back(prepared);
+	}
+}
+
+MinimaxMove PlayerMinimax::AspirationSearch(Bitboard board, const std::vector<U16> &nextMovesVec, int depth, int previousValue)
+{
+	// Aspiration windows are part of PVS
+	if (m_Algorithm != SearchAlgorithm::PVS || m_AspirationWindow <= 0)
+		return SearchRoot(board, nextMovesVec, depth, -MINIMAX_INFINITY, MINIMAX_INFINITY);
+
+	// Computed in 64 bits, a win value plus the window may not fit in an int
+	int alpha = (int)Max((long long)previousValue - m_AspirationWindow, (long long)-MINIMAX_INFINITY);
+	int beta  = (int)Min((long long)previousValue + m_AspirationWindow, (long long)MINIMAX_INFINITY);
+
+	/* A value outside the window is only a bound, search again with that side of the window open */
+	while (true)
+	{
+		MinimaxMove move = SearchRoot(board, nextMovesVec, depth, alpha, beta);
+		if (m_SearchStop.IsStopped())
+			return move;
+
+		if (move.value <= alpha && alpha > -MINIMAX_INFINITY)
+			alpha = -MINIMAX_INFINITY;
+		else if (move.value >= beta && beta < MINIMAX_INFINITY)
+			beta = MINIMAX_INFINITY;
+		else
+			return move;
+	}
+}
+
+MinimaxMove PlayerMinimax::SearchRoot(Bitboard board, const std::vector<U16> &nextMovesVec, int depth, int alpha, int beta)
+{
+	using namespace std;
+
+	// Winning with this move is the best possible result, searching stops once a move does (see MateDistanceBounds)
+	MateDistanceBounds(board, alpha, beta);
+
+	MoveList nextMoves;
+	nextMoves.count = (int)nextMovesVec.size();
+	for (int moveIndex = 0; moveIndex < nextMoves.count; moveIndex++)
+		nextMoves.moves[moveIndex] = nextMovesVec[moveIndex];
+	KeepForcedMoves(board, depth, nextMoves);
+	m_RootClearBits = board.GetClearBitsCount();
+
+	// The ADDITIONAL threads, they wait until a split point books them (sleeping at once to save power)
+	m_ThreadPool.BeginSearch(Max(m_NumberOfThreads - 1, 0),
+		[this](SearchThread &thread, SplitPoint &sp) { SearchSplitPoint(thread, sp); }, !m_PowerSaver);
+
+	// The main thread searches the root, and shares its moves when it may split
+	SearchThread mainThread(&m_ThreadPool);
+	MinimaxMove bestMove;
+	bestMove.value = SearchMoves(mainThread, board, nextMoves, depth, alpha, beta, true, bestMove.index);
+
+	m_ThreadPool.EndSearch();
+
+	// Every thread counted on its own, add them up now that none is searching
+	m_SearchStats.Add(mainThread.stats);
+	m_ThreadPool.CollectStats(m_SearchStats);
+	return bestMove;
 }
 
 //U16 PlayerMinimax::GetMove(Bitboard board)
@@ -119,102 +378,328 @@ U16 PlayerMinimax::GetMove(Bitboard board)
 //	return move.index;
 //}
 
-MinimaxMove PlayerMinimax::MinimaxWorker(Bitboard board, std::vector<U16> nextMoves)
+int PlayerMinimax::Search(SearchThread &thread, const Bitboard &board, int depth, int alpha, int beta)
 {
+	// Static values are for this player, negamax values are for the player to move
+	bool isPlayer = (board.GetPlayerTag() == m_PlayerTag);
 
-	//printf("moves got: %i\n", (int)nextMoves.size());
-   // Initialize the first move
-	MinimaxMove move;
-	move.value = -MINIMAX_INFINITY;
-	move.index = nextMoves[0];
+	SearchStats &stats = thread.stats;
+	stats.nodes++;
+	stats.maxPly = Max(stats.maxPly, m_RootClearBits - board.GetClearBitsCount());
 
-	for (int moveIndex = 0; moveIndex < nextMoves.size(); moveIndex++)
+	// Termination condition
+	if (board.GetWinner() != GameTag::Result_None || depth <= 0)
+	{
+		stats.leaves++;
+
+		// At the search depth, only forced moves are played on
+		if (board.GetWinner() == GameTag::Result_None && m_QuiescencePlies > 0)
+			return Quiescence(thread, board, m_QuiescencePlies);
+		return EvaluateLeaf(thread, board);
+	}
+
+	// Out of time or cut off by another thread, the value is ignored by the caller
+	if (m_SearchStop.CheckDeadline() || thread.IsCutOff())
+		return 0;
+
+	// No line from here can beat the fastest possible win, or lose faster than the fastest possible loss
+	if (MateDistanceBounds(board, alpha, beta))
+		return alpha;
+
+	/*
+	Look for a previous result of this position, possibly reached through another move order.
+	The table holds values for this player, for the other player the value is negated, so lower and upper bounds swap.
+	*/
+	int transform = 0;
+	U64 key = GetTableKey(board, transform);
+
+	TTEntry entry;
+	U16 hashMove = 0;
+	stats.tableProbes++;
+	if (m_TranspositionTable.Probe(key, entry))
 	{
-		Bitboard newBoard = board.DoMove(nextMoves[moveIndex]);
-		int newValue = Alphabeta(newBoard, m_SearchDepth - 1, -MINIMAX_INFINITY, MINIMAX_INFINITY);
-		if (newValue > move.value)
+		stats.tableHits++;
+		hashMove = Bitboard::TransformBoard(entry.move, Bitboard::InverseTransform(transform));
+		if (entry.depth >= depth)
 		{
-			move.index = nextMoves[moveIndex];
-			move.value = newValue;
+			int value = isPlayer ? entry.value : -entry.value;
+			TTBound bound = entry.bound;
+			if (!isPlayer && bound == TTBound::Lower)		bound = TTBound::Upper;
+			else if (!isPlayer && bound == TTBound::Upper)	bound = TTBound::Lower;
+
+			if (bound == TTBound::Lower)
+				alpha = Max(alpha, value);
+			else if (bound == TTBound::Upper)
+				beta = Min(beta, value);
+			if (bound == TTBound::Exact || alpha >= beta)
+			{
+				stats.tableCutoffs++;
+				return value;
+			}
 		}
+	}
 
-		using namespace std::chrono_literals;
-		if (m_PowerSaver)
-			std::this_thread::sleep_for(5ms);
+	U16 bestMove = hashMove;
+	int value;
+	int clearBits = board.GetClearBitsCount();
+	if (clearBits <= m_EndgameThreshold && depth >= clearBits)
+	{
+		// The search would reach the end of the game anyway, the solver gets there without static values
+		int drawValue = (board.GetPlayerTag() == m_PlayerTag) ? GetDrawValue() : -GetDrawValue();
+		value = EndgameSolver::Solve(board, alpha, beta, MINIMAX_WIN, drawValue, stats);
 	}
-	return move;
+	else
+	{
+		// Search the best move of the previous result first, then killers and moves with a good history
+		MoveList nextMoves;
+		board.GetAvailableMoves(nextMoves);
+		KeepForcedMoves(board, depth, nextMoves);
+		m_MoveOrdering.OrderMoves(board, nextMoves, hashMove);
+
+		value = SearchMoves(thread, board, nextMoves, depth, alpha, beta, false, bestMove);
+		if (ShouldStop(thread))
+			return 0;
+	}
+
+	// Classify the result by the window the moves were searched with
+	TTBound bound = TTBound::Exact;
+	if (value <= alpha)
+		bound = isPlayer ? TTBound::Upper : TTBound::Lower;
+	else if (value >= beta)
+		bound = isPlayer ? TTBound::Lower : TTBound::Upper;
+	m_TranspositionTable.Store(key, isPlayer ? value : -value, depth, bound, Bitboard::TransformBoard(bestMove, transform));
+
+	return value;
 }
 
-std::vector<std::vector<int>> PlayerMinimax::DistributeWork(int moveCount, int numberOfThreads)
+int PlayerMinimax::SearchMoves(SearchThread &thread, const Bitboard &board, const MoveList &nextMoves, int depth, int alpha, int beta, bool isRoot, U16 &bestMove)
 {
-	using namespace std;
-	vector<vector<int>> dist;
-	int baseNumber = moveCount / numberOfThreads;		// Number of move each worker gets, -1 because range is exclusive
-	int remainder = moveCount % numberOfThreads;		// The rest, distributed evenly across workers
+	int bestValue = -MINIMAX_INFINITY;
+	bestMove = nextMoves.moves[0];
 
-	// Set the moves to be calculated by main first, 
-	// to make sure the main gets the least 
-	dist.push_back(vector<int>({0, baseNumber}));
+	for (int moveIndex = 0; moveIndex < nextMoves.count; moveIndex++)
+	{
+		// Young brothers wait: once the first move is searched, the others may be shared with idle threads
+		if (moveIndex > 0 && depth >= SPLIT_MIN_DEPTH && thread.pool->HasIdleHelper())
+			return Split(thread, board, nextMoves, moveIndex, depth, alpha, beta, isRoot, bestValue, bestMove);
 
-	//printf("(%i,%i)\n", dist[0][0], dist[0][1]);
-	//printf("count=%i th=%i \n", moveCount, numberOfThreads);
+		U16 move = nextMoves.moves[moveIndex];
+		int value = SearchChild(thread, board.DoMoveUnchecked(move), depth, alpha, beta, moveIndex > 0);
+		if (ShouldStop(thread))
+			return 0;
 
-	// Set moves for additional threads
-	for (int i = 1; i < m_NumberOfThreads; ++i)
-	{
-		// If more extra moves remain, give one the the worker
-		int extra = remainder-- > 0 ? 1 : 0;
+		// Better than every root move searched before, even if the rest of the search is stopped
+		if (isRoot && value > alpha)
+			m_SearchStop.SetBestMove(move);
 
-		// To get the numbers of the moves, we use the last number of the previous thread
-		// note that range of vectors is [inclusive, exclusive]
-		dist.push_back(vector<int>({dist[i - 1][1], dist[i - 1][1] + baseNumber + extra}));
+		if (value > bestValue)
+		{
+			bestValue = value;
+			bestMove = move;
+		}
+		alpha = Max(alpha, bestValue);
+
+		if (alpha >= beta)
+		{
+			thread.stats.cutoffs[moveIndex]++;
+			m_MoveOrdering.RecordCutoff(board, move, depth);
+			break;
+		}
+
+		using namespace std::chrono_literals;
+		if (isRoot && m_PowerSaver)
+			std::this_thread::sleep_for(5ms);
 	}
-	return dist;
+	return bestValue;
 }
 
-int PlayerMinimax::Alphabeta(Bitboard board, int depth, int alpha, int beta)
+int PlayerMinimax::SearchChild(SearchThread &thread, const Bitboard &child, int depth, int alpha, int beta, bool isLaterMove)
 {
-	// Termination condition
-	if (depth <= 0 || board.GetWinner() != GameTag::Result_None)
-		return GetStaticValue(board);
+	// PVS expects the first move to be the best, the others only have to be proven worse with a zero window
+	if (isLaterMove && m_Algorithm == SearchAlgorithm::PVS)
+	{
+		int value = -Search(thread, child, depth - 1, -alpha - 1, -alpha);
+		if (value > alpha && value < beta && !ShouldStop(thread))
+			value = -Search(thread, child, depth - 1, -beta, -alpha);
+		return value;
+	}
+	return -Search(thread, child, depth - 1, -beta, -alpha);
+}
+
+int PlayerMinimax::Split(SearchThread &thread, const Bitboard &board, const MoveList &nextMoves, int firstMove,
+	int depth, int alpha, int beta, bool isRoot, int bestValue, U16 &bestMove)
+{
+	SplitPoint sp(board, nextMoves, firstMove, depth, alpha, beta, bestValue, bestMove, isRoot, thread.activeSplit);
+	thread.activeSplit = &sp;
+
+	thread.pool->BookHelpers(sp);
+	SearchSplitPoint(thread, sp);
+
+	// The split point lives on this stack, wait until the helpers are done with it
+	sp.WaitForSlaves();
 
-	U16 *nextMoves = board.GetAvailableMoves();
-	int moveCount = board.GetClearBitsCount();
-	Bitboard newBoard;
+	thread.activeSplit = sp.parent;
+	bestMove = sp.bestMove;
+	return sp.bestValue;
+}
 
-	int value = -MINIMAX_INFINITY;
+void PlayerMinimax::SearchSplitPoint(SearchThread &thread, SplitPoint &sp)
+{
+	while (true)
+	{
+		// Take the next move and the best alpha found so far by any thread
+		U16 move;
+		int moveIndex;
+		int alpha;
+		{
+			std::lock_guard<std::mutex> guard(sp.lock);
+			if (sp.cutoff || sp.nextMove >= sp.moves.count)
+				return;
+			moveIndex = sp.nextMove++;
+			move = sp.moves.moves[moveIndex];
+			alpha = sp.alpha;
+		}
+
+		int value = SearchChild(thread, sp.board.DoMoveUnchecked(move), sp.depth, alpha, sp.beta, true);
+		if (ShouldStop(thread))
+			return;
 
-	if (board.GetPlayerTag() == m_PlayerTag)	// maximizing player
-		for (int moveIndex = 0; moveIndex < moveCount; moveIndex++)
 		{
-			newBoard = board.DoMove(nextMoves[moveIndex]);
-			value = Max(value, Alphabeta(newBoard, depth - 1, alpha, beta));
-			alpha = Max(alpha, value);
+			std::lock_guard<std::mutex> guard(sp.lock);
+			if (sp.isRoot && value > sp.alpha)
+				m_SearchStop.SetBestMove(move);
+			if (value > sp.bestValue)
+			{
+				sp.bestValue = value;
+				sp.bestMove = move;
+			}
+			sp.alpha = Max(sp.alpha, value);
+
+			// Stop the other threads of this split point, and everything they split below it
+			if (sp.alpha >= sp.beta && !sp.cutoff)
+			{
+				sp.cutoff = true;
+				thread.stats.cutoffs[moveIndex]++;
+				m_MoveOrdering.RecordCutoff(sp.board, move, sp.depth);
+			}
+		}
 
-			if (alpha >= beta)
+		using namespace std::chrono_literals;
+		if (sp.isRoot && m_PowerSaver)
+			std::this_thread::sleep_for(5ms);
+	}
+}
+
+bool PlayerMinimax::MateDistanceBounds(const Bitboard &board, int &alpha, int &beta)
+{
+	/*
+	The player to move wins at best with this move, leaving one clear square less,
+	and loses at worst on the next move of the other player, leaving two clear squares less.
+	Static values of unfinished boards stay below win values, so they are within the bounds too.
+	*/
+	int clearBits = board.GetClearBitsCount();
+	alpha = Max(alpha, -(MINIMAX_WIN + clearBits - 2));
+	beta = Min(beta, MINIMAX_WIN + clearBits - 1);
+	return alpha >= beta;
+}
+
+void PlayerMinimax::KeepForcedMoves(const Bitboard &board, int depth, MoveList &moves)
+{
+	/*
+	A winning move has the best possible value, the first one is enough.
+	Otherwise, if the other player can win, every move that doesn't block loses at once.
+	That is only seen with 2 plies to go or by the quiescence search, without it such moves are valued
+	by the static evaluation at depth 1 and pruning them would change the result.
+	*/
+	U16 forced = board.GetWinningSquares(board.GetPlayerTag());
+	bool isWin = (forced != 0);
+	if (!isWin && (depth >= 2 || m_QuiescencePlies > 0))
+		forced = board.GetWinningSquares(board.GetOtherPlayerTag());
+	if (forced == 0)
+		return;
+
+	int count = 0;
+	for (int moveIndex = 0; moveIndex < moves.count; moveIndex++)
+		if (moves.moves[moveIndex] & forced)
+		{
+			moves.moves[count++] = moves.moves[moveIndex];
+			if (isWin)
 				break;
 		}
-	else // minimizing player
+	moves.count = count;
+}
+
+int PlayerMinimax::Quiescence(SearchThread &thread, const Bitboard &board, int plies)
+{
+	if (board.GetWinner() != GameTag::Result_None)
+		return EvaluateLeaf(thread, board);
+
+	/*
+	Wins and losses found here get the same values as in the full search (see GetStaticValue),
+	the win value plus the clear squares left when the game ends:
+		1. The player to move can win:				wins on this move
+		2. The other player can win in two places:	only one can be blocked, loses on the next move
+		3. The other player can win in one place:	the block is forced, play it and look again
+		4. The player to move can make two wins:	only one can be blocked, wins on the move after
+	Otherwise the board is quiet and gets its static value.
+	Every step but 3 ends the search, and 3 plays one move, so the search is a single line of at most 'plies' moves.
+	*/
+	int clearBits = board.GetClearBitsCount();
+	U16 ownWins = board.GetWinningSquares(board.GetPlayerTag());
+	if (ownWins)
+		return MINIMAX_WIN + clearBits - 1;
+
+	U16 otherWins = board.GetWinningSquares(board.GetOtherPlayerTag());
+	if (otherWins & (otherWins - 1))
+		return -(MINIMAX_WIN + clearBits - 2);
+
+	if (otherWins)
 	{
-		value = MINIMAX_INFINITY;
-		for (int moveIndex = 0; moveIndex < moveCount; moveIndex++)
+		if (plies > 0)
 		{
-			newBoard = board.DoMove(nextMoves[moveIndex]);
-			value = Min(value, Alphabeta(newBoard, depth - 1, alpha, beta));
-			beta = Min(beta, value);
-
-			if (alpha >= beta)
-				break;
+			// The board at the search depth is counted as a node of the search, the boards past it here
+			Bitboard block = board.DoMoveUnchecked(otherWins);
+			thread.stats.quiescenceNodes++;
+			thread.stats.maxPly = Max(thread.stats.maxPly, m_RootClearBits - block.GetClearBitsCount());
+			return -Quiescence(thread, block, plies - 1);
+		}
+	}
+	else if (plies > 0 && clearBits >= 3)
+	{
+		// The other player can't win on the next move, so a double threat can't be answered
+		for (U16 moves = board.GetAvailableMovesMask(); moves; )
+		{
+			U16 move = Bitboard::PopMove(moves);
+			U16 threats = board.DoMoveUnchecked(move).GetWinningSquares(board.GetPlayerTag());
+			if (threats & (threats - 1))
+				return MINIMAX_WIN + clearBits - 3;
 		}
 	}
 
-	delete[] nextMoves;
-	return value;
+	return EvaluateLeaf(thread, board);
+}
+
+int PlayerMinimax::EvaluateLeaf(SearchThread &thread, const Bitboard &board)
+{
+	thread.stats.staticEvaluations++;
+
+	// Static values are for this player, negamax values are for the player to move
+	Bitboard leaf = board;
+	int value = GetStaticValue(leaf);
+	return (board.GetPlayerTag() == m_PlayerTag) ? value : -value;
+}
+
+U64 PlayerMinimax::GetTableKey(const Bitboard &board, int &transform)
+{
+	// With a symmetric evaluation, results are shared by all symmetric boards and stored in canonical form.
+	transform = 0;
+	return m_bSymmetricKeys ?
+		TranspositionTable::HashBoard(board.GetCanonical(transform)) :
+		TranspositionTable::HashBoard(board);
 }
 
 int PlayerMinimax::GetStaticValue(Bitboard &board)
 {
-	svCount++;	// Count number of static evaluations performed
 	GameTag winner = board.GetWinner();
 
 	GameTag otherPlayer =
@@ -223,10 +708,10 @@ int PlayerMinimax::GetStaticValue(Bitboard &board)
 	int value = 0;
 
 	if (winner == m_PlayerTag)
-		value = 1000000000 + board.GetClearBitsCount();
+		value = MINIMAX_WIN + board.GetClearBitsCount();
 
 	if (winner == otherPlayer)
-		value = -1000000000 - board.GetClearBitsCount();
+		value = -MINIMAX_WIN - board.GetClearBitsCount();
 
 	else if (winner == GameTag::Result_None && m_bUseChainScore)
 		value = board.ChainScoreForPlayer(m_PlayerTag);
@@ -1,7 +1,15 @@
 #pragma once
 #include "Player.h"
+#include "TranspositionTable.h"
+#include "MoveOrdering.h"
+#include "ParallelSearch.h"
+#include "EndgameSolver.h"
+#include "SearchStop.h"
 #include <vector>
 #include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 struct MinimaxMove
 {
@@ -9,6 +17,65 @@ struct MinimaxMove
 	int value;
 };
 
+// Limit of the forced moves played past the search depth when the quiescence search is turned on (it's off by default),
+// see PlayerMinimax::SetQuiescencePlies
+const int QUIESCENCE_PLIES = 4;
+
+// Number of clear squares from which boards are solved to the end when the endgame solver is turned on (it's off by default),
+// see PlayerMinimax::SetEndgameThreshold
+const int ENDGAME_THRESHOLD = 10;
+
+/*
+The thread of a player searching on the other player's time, and the request to stop it.
+Copies of a player don't ponder, so players stay copyable.
+*/
+class PonderThread
+{
+public:
+
+	PonderThread() : m_bStopRequested(false) {}
+	PonderThread(const PonderThread &) : PonderThread() {}
+	PonderThread &operator=(const PonderThread &) { return *this; }
+
+	/* The owner must stop the work before it's destroyed. */
+	~PonderThread() { Join(); }
+
+	template<class Work>
+	void Start(Work work)
+	{
+		m_bStopRequested = false;
+		m_Thread = std::thread(work);
+	}
+
+	void RequestStop() { m_bStopRequested = true; }
+	inline bool IsStopRequested() const { return m_bStopRequested.load(); }
+
+	void Join() { if (m_Thread.joinable()) m_Thread.join(); }
+	inline bool IsRunning() const { return m_Thread.joinable(); }
+
+private:
+
+	std::thread m_Thread;
+	std::atomic<bool> m_bStopRequested;
+};
+
+/* A reply prepared while pondering, for the board after one move of the other player. */
+struct PreparedMove
+{
+	U16 xBoard;
+	U16 oBoard;
+	U16 move;
+	int value;
+	int depth;
+};
+
+/* The search used by PlayerMinimax below the root. */
+enum class SearchAlgorithm
+{
+	AlphaBeta,		// Alpha-beta pruning, every move gets the full window
+	PVS				// Principal variation search with aspiration windows
+};
+
 class PlayerMinimax :
 	public Player
 {
@@ -29,24 +96,140 @@ public:
 		m_NumberOfThreads(maxNumberOfThreads),
 		m_Verbose(verbose),
 		m_PowerSaver(powerSave),
-		svCount(0)
+		m_bSymmetricKeys(true),
+		m_TimeLimit(0),
+		m_Algorithm(SearchAlgorithm::AlphaBeta),
+		m_AspirationWindow(16),
+		m_QuiescencePlies(0),
+		m_EndgameThreshold(0),
+		m_bPonder(false),
+		m_RootClearBits(0)
 	{};
 	
-	virtual ~PlayerMinimax() {}
+	virtual ~PlayerMinimax() { StopPondering(0); }
 
 	virtual U16 GetMove(Bitboard board);
 
+	/*
+	Search the likely replies of the other player while it thinks, and prepare an answer to each.
+	If the reply that is played was searched, GetMove returns its answer at once.
+	Only done after SetPondering(true).
+	*/
+	virtual void StartPondering(Bitboard board);
+	virtual void StopPondering(U16 otherMove);
+
+	/*
+	Results, best moves and move ordering are kept from move to move, the boards of this move were mostly
+	searched as part of the previous one. Their values are for this player and don't depend on the board
+	the search started from, so they stay right until the evaluation changes. Drops them all.
+	*/
+	virtual void NewGame();
+
+	void SetPondering(bool ponder) { m_bPonder = ponder; }
+
+	/*
+	Make a running GetMove return the move of its last completed iteration (or the best root move searched
+	so far at a fixed depth). The worker threads see it at their next node.
+	*/
+	virtual void StopSearch() { m_SearchStop.Stop(); }
+	virtual unsigned ReserveSearch() { return m_SearchStop.Reserve(); }
+	virtual void StopRequest(unsigned request) { m_SearchStop.StopRequest(request); }
+	virtual U16 GetBestMoveSoFar() { return m_SearchStop.GetBestMove(); }
+
+	/* Resize the transposition table to 2^sizeLog2 entries and set its replacement policy. */
+	void SetTranspositionTable(int sizeLog2, TTReplacement policy = TTReplacement::DepthPreferred) {
+		m_TranspositionTable = TranspositionTable(sizeLog2, policy); }
+
+	/*
+	Search every move for a number of milliseconds with iterative deepening, instead of to a fixed depth.
+	The move of the deepest completed iteration is played. 0 turns the time limit off.
+	*/
+	void SetTimeLimit(int milliseconds) { m_TimeLimit = (milliseconds > 0) ? milliseconds : 0; }
+
+	/*
+	Select the search algorithm. PVS always deepens iteratively (to the search depth when there is no time limit),
+	so every iteration can start with a window of +-aspirationWindow around the value of the previous one.
+	*/
+	void SetSearchAlgorithm(SearchAlgorithm algorithm) { m_Algorithm = algorithm; }
+	void SetAspirationWindow(int aspirationWindow) { m_AspirationWindow = aspirationWindow; }
+
+	/*
+	Limit the forced moves (blocks of immediate wins) played past the search depth, see Quiescence.
+	0 turns the quiescence search off, boards at the search depth then get their static value. Off by default,
+	so values (and everything baked or evolved from them) stay those of the plain search unless a player opts in.
+	*/
+	void SetQuiescencePlies(int plies) { m_QuiescencePlies = (plies > 0) ? plies : 0; m_TranspositionTable.NewGame(); }
+
+	/*
+	Solve boards with at most this many clear squares exactly with the endgame solver (see EndgameSolver.h).
+	A move from such a board is always solved, whatever the search depth or time limit.
+	Inside the search, boards are solved when the remaining depth reaches the end of the game. 0 turns it off.
+	Off by default: the solver plays perfectly past the search depth and ignores GetStaticValue but for wins,
+	losses and GetDrawValue, so players opt in.
+	*/
+	void SetEndgameThreshold(int clearSquares)
+	{
+		m_EndgameThreshold = (clearSquares > 0) ? clearSquares : 0;
+		m_TranspositionTable.NewGame();
+	}
+
+	/* Counters of the last GetMove, added up over all threads. Empty when a pondered answer was played. */
+	const SearchStats &GetSearchStats() const { return m_Stats; }
+
 private:
 
-	/* Gets a board and moves and retures the best move. 
-	Used by GetMove to calculate part of the tree, to suppot multithreading. */
-	MinimaxMove MinimaxWorker(Bitboard board, std::vector<U16> nextMoves);
+	/* Searches a board to the search depth or for the time limit, and returns the best move found. */
+	MinimaxMove SearchBoard(Bitboard board, int &completedDepth);
+
+	/* Returns the best move of a board with few clear squares, solved to the end with the endgame solver. */
+	MinimaxMove SolveEndgame(const Bitboard &board);
+
+	/* Prepares answers to the replies of the other player on the board, until asked to stop. Runs on the ponder thread. */
+	void Ponder(Bitboard board);
+
+	/* Searches all moves to the given depth with all threads (see ParallelSearch.h), and returns the best one. */
+	MinimaxMove SearchRoot(Bitboard board, const std::vector<U16> &nextMoves, int depth, int alpha, int beta);
+
+	/* Searches the root with a window around the previous value, and widens it if the value falls outside. */
+	MinimaxMove AspirationSearch(Bitboard board, const std::vector<U16> &nextMoves, int depth, int previousValue);
+
+	/* Negamax search of a board, values are for the player to move. Used by both algorithms. */
+	int Search(SearchThread &thread, const Bitboard &board, int depth, int alpha, int beta);
+
+	/* Searches the moves of a board in order and returns the best value, splits when threads are idle. */
+	int SearchMoves(SearchThread &thread, const Bitboard &board, const MoveList &nextMoves, int depth, int alpha, int beta,
+		bool isRoot, U16 &bestMove);
+
+	/* Searches the board after a move, with a zero window first for later moves of PVS. */
+	int SearchChild(SearchThread &thread, const Bitboard &child, int depth, int alpha, int beta, bool isLaterMove);
 
-	/* Distributes the number of moves evenly for each thread */
-	std::vector<std::vector<int>> DistributeWork(int moveCount, int numberOfThreads);
+	/* Shares the moves from firstMove on with idle threads, and returns the best value of the board. */
+	int Split(SearchThread &thread, const Bitboard &board, const MoveList &nextMoves, int firstMove,
+		int depth, int alpha, int beta, bool isRoot, int bestValue, U16 &bestMove);
 
-	/* Regular minimax functions */
-	int Alphabeta(Bitboard board, int depth, int alpha, int beta);
+	/* Searches moves of a split point until none remain or one fails high. */
+	void SearchSplitPoint(SearchThread &thread, SplitPoint &sp);
+
+	/* Returns true if the search of this thread was interrupted, by the time limit or a cutoff of another thread. */
+	inline bool ShouldStop(const SearchThread &thread) const { return m_SearchStop.IsStopped() || thread.IsCutOff(); }
+
+	/*
+	Searches past the search depth while the play is forced: immediate wins, forced blocks and double threats.
+	Plays at most 'plies' blocks, returns a negamax value for the player to move.
+	*/
+	int Quiescence(SearchThread &thread, const Bitboard &board, int plies);
+
+	/* Returns the static value of a board for the player to move, and counts the evaluation */
+	int EvaluateLeaf(SearchThread &thread, const Bitboard &board);
+
+	/* Narrows the window to the values still possible given the fastest win and loss, returns true if it's empty */
+	bool MateDistanceBounds(const Bitboard &board, int &alpha, int &beta);
+
+	/* Removes every move but a win, or the blocks of the other player's wins, when there are any */
+	void KeepForcedMoves(const Bitboard &board, int depth, MoveList &moves);
+
+	/* Returns the board's key in the transposition table, and the symmetry used for its moves */
+	U64 GetTableKey(const Bitboard &board, int &transform);
 
 	/* Limit the depth to 16 (and above 0) */
 	int  CapSearchDepth(int depth) { 
@@ -68,6 +251,50 @@ private:
 	// Sleep to avoid CPU overheating
 	bool m_PowerSaver;
 
+	// Results of searched positions, shared by all worker threads
+	TranspositionTable m_TranspositionTable;
+
+	// Helper threads, kept between moves
+	SearchThreadPool m_ThreadPool;
+
+	// Killer moves and history scores, shared by all worker threads
+	MoveOrdering m_MoveOrdering;
+
+	// Symmetric boards share transposition table entries, set from HasSymmetricEvaluation() every move
+	bool m_bSymmetricKeys;
+
+	// Milliseconds per move for iterative deepening, 0 to search to m_SearchDepth
+	int m_TimeLimit;
+
+	// Interrupts the search when the time limit is reached
+	SearchStop m_SearchStop;
+
+	SearchAlgorithm m_Algorithm;
+
+	// Half the width of the first window of every PVS iteration, 0 for a full window
+	int m_AspirationWindow;
+
+	// Most forced moves played by the quiescence search at the search depth, 0 for none
+	int m_QuiescencePlies;
+
+	// Boards with at most this many clear squares are solved to the end, 0 for none
+	int m_EndgameThreshold;
+
+	// Search on the other player's time
+	bool m_bPonder;
+	PonderThread m_Ponder;
+
+	// The board the other player is moving on while pondering, and the answers prepared so far
+	Bitboard m_PonderBoard;
+	std::vector<PreparedMove> m_PreparedMoves;
+
+	// Clear squares of the board being searched, plies are counted from it
+	int m_RootClearBits;
+
+	// Counters of the running search, and of the last move
+	SearchStats m_SearchStats;
+	SearchStats m_Stats;
+
 protected:
 
 	// Default without chainscore (no need to use chain score because NN's override evaluation)
@@ -76,14 +303,29 @@ protected:
 		m_SearchDepth(CapSearchDepth(depth)),
 		m_bUseChainScore(false),
 		m_NumberOfThreads(maxNumberOfThreads),
-		svCount(0)
+		m_Verbose(false),
+		m_PowerSaver(false),
+		m_bSymmetricKeys(true),
+		m_TimeLimit(0),
+		m_Algorithm(SearchAlgorithm::AlphaBeta),
+		m_AspirationWindow(16),
+		m_QuiescencePlies(0),
+		m_EndgameThreshold(0),
+		m_bPonder(false),
+		m_RootClearBits(0)
 	{};
 
 	/* Returns static value for a board */
 	virtual int GetStaticValue(Bitboard &board);
 
-	// Count of static evaluations performed in last move
-	int svCount;
+	/* Returns true if symmetric boards always get the same static value */
+	virtual bool HasSymmetricEvaluation() { return true; }
+
+	/*
+	Returns the static value of a drawn board for this player, the value the endgame solver gives draws.
+	It must be the value GetStaticValue returns for every full board without a winner.
+	*/
+	virtual int GetDrawValue() const { return 0; }
 
 };
 
@@ -24,6 +24,7 @@ PlayerMinimaxLookup::PlayerMinimaxLookup(GameTag tag, int depth, int maxNumberOf
 	else
 	{
 		string line;
+		bool rewriteFile = false;
 		while (getline(in, line))
 		{
 			/* Interpret each line as std::pair<U32, U16> */
@@ -34,27 +35,54 @@ PlayerMinimaxLookup::PlayerMinimaxLookup(GameTag tag, int depth, int maxNumberOf
 			string move_s = line.substr(pos+2, line.size() - pos - 1);
 			key	 = stoul(key_s);
 			move = (U16)stoul(move_s);
-			m_LookupMap.insert(pair<const U32, U16>(key, move));
+
+			/* Older files may contain boards which are not in canonical form, convert them */
+			U16 playerBoard = (U16)(key >> 16);
+			U16 otherBoard = (U16)key;
+			int transform = (m_PlayerTag == GameTag::Player_X) ?
+				Bitboard::FindCanonicalTransform(playerBoard, otherBoard) :
+				Bitboard::FindCanonicalTransform(otherBoard, playerBoard);
+			if (transform != 0)
+			{
+				key = (U32)Bitboard::TransformBoard(playerBoard, transform) << 16 | Bitboard::TransformBoard(otherBoard, transform);
+				move = Bitboard::TransformBoard(move, transform);
+			}
+
+			// Converted in memory only, the file keeps old boards and duplicates of symmetric boards unless rewritten
+			if (!m_LookupMap.insert(pair<const U32, U16>(key, move)).second || transform != 0)
+				rewriteFile = true;
 		}
 		in.close();
+
+		// New entries are appended in canonical form either way, rewriting only makes the file smaller
+		if (rewriteFile && GameManager::DisplayPolarQuestion("The lookup file has boards in the old format. Rewrite it in canonical form?"))
+		{
+			ofstream out(filename, ios::trunc);
+			for (auto &entry : m_LookupMap)
+				out << entry.first << "->" << entry.second << endl;
+		}
 	}
 }
 
 U16 PlayerMinimaxLookup::GetMove(Bitboard board)
 {
-	U32 key = board.EncodeBoardU32(m_PlayerTag);
+	// Symmetric boards share one entry, saved in canonical form
+	int transform;
+	U32 key = board.GetCanonical(transform).EncodeBoardU32(m_PlayerTag);
 	
 	// If the key doesn't exist, get move using minimax and save it
 	// map.find() is better than map.count() because it's <= O(n), while count is == O(n)
-	if (m_LookupMap.find(key) == m_LookupMap.end())		
+	auto found = m_LookupMap.find(key);
+	if (found == m_LookupMap.end())		
 	{
 		// Each entry is saved in a seperate line: board$bestmove\n
 		ofstream out(m_LookupFilename, ios::app);
 		U16 move = PlayerMinimax::GetMove(board);
-		out << key << "->" << move << endl;
-		m_LookupMap.insert(pair<const U32, U16>(key, move));
+		U16 canonicalMove = Bitboard::TransformBoard(move, transform);
+		out << key << "->" << canonicalMove << endl;
+		m_LookupMap.insert(pair<const U32, U16>(key, canonicalMove));
 		return move;
 	}
-	// Return the move found in lookup map
-	else return m_LookupMap[key];
+	// Return the move found in lookup map, mapped back from the canonical board
+	else return Bitboard::TransformBoard(found->second, Bitboard::InverseTransform(transform));
 }
\ No newline at end of file
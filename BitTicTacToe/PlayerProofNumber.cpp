@@ -0,0 +1,16 @@
+#include "PlayerProofNumber.h"
+#include <stdio.h>
+
+U16 PlayerProofNumber::GetMove(Bitboard board)
+{
+	ProofResult result = m_Solver.SolvePosition(board);
+
+	if (m_Verbose)
+	{
+		const char *names[] = { "unknown", "win", "draw", "loss" };
+		printf("\nresult: %s | proof size: %llu boards | %.1f ms\n",
+			names[(int)result.result], (unsigned long long)result.nodes, result.milliseconds);
+	}
+
+	return result.move;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "Player.h"
+#include "ProofNumberSearch.h"
+
+class PlayerProofNumber :
+	public Player
+{
+public:
+	/* Plays perfect moves by solving every position with proof-number search.
+	The solver's table of 2^tableSizeLog2 slots is kept for the whole game. */
+	PlayerProofNumber(GameTag tag = GameTag::Player_X, int tableSizeLog2 = 18, bool verbose = true) :
+		Player(tag),
+		m_Solver(tableSizeLog2),
+		m_Verbose(verbose) {}
+
+	~PlayerProofNumber() {}
+
+	virtual U16 GetMove(Bitboard board) final;
+
+private:
+
+	ProofNumberSolver m_Solver;
+
+	// Should print result
+	bool m_Verbose;
+};
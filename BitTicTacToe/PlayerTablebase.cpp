@@ -0,0 +1,58 @@
+#include "PlayerTablebase.h"
+#include "GameManager.h"
+
+PlayerTablebase::PlayerTablebase(GameTag tag, int depth, int maxNumberOfThreads, const char *filename) :
+	PlayerMinimax(tag, depth, maxNumberOfThreads)
+{
+	// Try to open the file, if failed ask to create it
+	if (!m_Tablebase.Open(filename))
+	{
+		if (GameManager::DisplayPolarQuestion("Create new tablebase?"))
+		{
+			if (!Tablebase::Generate(filename, maxNumberOfThreads) || !m_Tablebase.Open(filename))
+				printf("Unable to load tablebase, using regular search.\n");
+		}
+	}
+}
+
+U16 PlayerTablebase::GetMove(Bitboard board)
+{
+	if (!m_Tablebase.IsOpen())
+		return PlayerMinimax::GetMove(board);
+
+	MoveList nextMoves;
+	board.GetAvailableMoves(nextMoves);
+
+	/* 
+	Look up every next board, the results are for the opponent.
+	Prefer the fastest win, then a draw, then the slowest loss.
+	*/
+	U16 bestMove = nextMoves.moves[0];
+	int bestScore = -1000;
+
+	for (int moveIndex = 0; moveIndex < nextMoves.count; moveIndex++)
+	{
+		Bitboard newBoard = board.DoMoveUnchecked(nextMoves.moves[moveIndex]);
+
+		int score = 0;
+		if (newBoard.GetWinner() == m_PlayerTag)
+			score = 100;
+		else if (newBoard.GetWinner() == GameTag::Result_None)
+		{
+			int distance = m_Tablebase.GetDistance(newBoard);
+			switch (m_Tablebase.GetResult(newBoard))
+			{
+			case TablebaseResult::Loss:	score = 100 - distance;	break;
+			case TablebaseResult::Win:	score = distance - 100;	break;
+			default:					score = 0;				break;
+			}
+		}
+
+		if (score > bestScore)
+		{
+			bestScore = score;
+			bestMove = nextMoves.moves[moveIndex];
+		}
+	}
+	return bestMove;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "PlayerMinimax.h"
+#include "Tablebase.h"
+
+class PlayerTablebase :
+	public PlayerMinimax
+{
+public:
+	/* Plays perfect moves using a solved tablebase file.
+	If the file is missing it offers to generate it, otherwise it falls back to regular search. */
+	PlayerTablebase(GameTag tag = GameTag::Player_X, int depth = 9, int maxNumberOfThreads = 4, const char *filename = "_tablebase.dat");
+
+	~PlayerTablebase() {}
+
+	virtual U16 GetMove(Bitboard board) final;
+
+private:
+
+	Tablebase m_Tablebase;
+};
@@ -0,0 +1,265 @@
+#include "ProofNumberSearch.h"
+#include <chrono>
+
+using namespace std;
+
+// Numbers of solved boards. Sums of unsolved numbers stop below it, so they never look solved
+static const U32 PN_INFINITY = 1 << 30;
+
+/* Adds two numbers, saturating: infinity stays infinity and finite sums stay below it */
+static inline U32 AddNumbers(U32 n1, U32 n2)
+{
+	if (n1 >= PN_INFINITY || n2 >= PN_INFINITY)
+		return PN_INFINITY;
+	return (n1 + n2 < PN_INFINITY) ? n1 + n2 : PN_INFINITY - 1;
+}
+
+ProofNumberSolver &ProofNumberSolver::operator=(const ProofNumberSolver &other)
+{
+	if (this != &other)
+	{
+		// Only the configuration is copied, see the copy constructor
+		m_SizeLog2 = other.m_SizeLog2;
+		m_Slots.reset();
+	}
+	return *this;
+}
+
+void ProofNumberSolver::Clear()
+{
+	if (!m_Slots)
+		return;
+
+	size_t size = (size_t)1 << m_SizeLog2;
+	for (size_t index = 0; index < size; index++)
+		m_Slots[index] = Slot{ 0, 0, 0, 0 };
+}
+
+ProofResult ProofNumberSolver::SolvePosition(const Bitboard &board, U64 maxNodes)
+{
+	auto start = chrono::high_resolution_clock::now();
+
+	if (!m_Slots)
+	{
+		m_Slots.reset(new Slot[(size_t)1 << m_SizeLog2]);
+		Clear();
+	}
+	m_Nodes = 0;
+	m_MaxNodes = maxNodes;
+
+	ProofResult result;
+	GameTag player = board.GetPlayerTag();
+	GameTag other = board.GetOtherPlayerTag();
+
+	if (board.GetWinner() != GameTag::Result_None)
+	{
+		// The game is over, the last move decided it
+		result.result = (board.GetWinner() == GameTag::Result_Draw) ? TablebaseResult::Draw : TablebaseResult::Loss;
+	}
+	else if (Prove(board, player) == 0)
+	{
+		// A proof of the player's win needs one winning move
+		result.result = TablebaseResult::Win;
+		result.move = FindSolvedMove(board);
+	}
+	else if (m_MaxNodes == 0 || m_Nodes < m_MaxNodes)
+	{
+		// The player can't win, the other proof decides between a draw and a loss
+		U32 phi = Prove(board, other);
+		if (phi == 0)
+		{
+			result.result = TablebaseResult::Draw;
+			result.move = FindSolvedMove(board);
+		}
+		else if (phi >= PN_INFINITY)
+		{
+			result.result = TablebaseResult::Loss;
+
+			// Every move loses, block the other player's win if there is one so the game goes on
+			U16 blocks = board.GetWinningSquares(other);
+			MoveList moves;
+			board.GetAvailableMoves(moves);
+			result.move = moves.moves[0];
+			for (int index = 0; index < moves.count; index++)
+				if (moves.moves[index] & blocks)
+				{
+					result.move = moves.moves[index];
+					break;
+				}
+		}
+	}
+
+	result.nodes = m_Nodes;
+	chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+	result.milliseconds = elapsed.count();
+	return result;
+}
+
+U32 ProofNumberSolver::Prove(const Bitboard &board, GameTag attacker)
+{
+	m_Attacker = attacker;
+
+	U32 phi, delta;
+	if (Evaluate(board, phi, delta))
+		return phi;
+
+	Search(board, PN_INFINITY, PN_INFINITY, phi, delta);
+	return phi;
+}
+
+void ProofNumberSolver::Search(const Bitboard &board, U32 thresholdPhi, U32 thresholdDelta, U32 &phi, U32 &delta)
+{
+	U64 startNodes = m_Nodes++;
+
+	MoveList moves;
+	board.GetAvailableMoves(moves);
+
+	U32 childPhi[16], childDelta[16];
+	for (int index = 0; index < moves.count; index++)
+		GetNumbers(board.DoMoveUnchecked(moves.moves[index]), childPhi[index], childDelta[index]);
+
+	while (true)
+	{
+		/* Find the most proving child (smallest delta) and the second smallest delta, for its threshold */
+		int best = 0;
+		U32 secondDelta = PN_INFINITY;
+		phi = PN_INFINITY;
+		delta = 0;
+		for (int index = 0; index < moves.count; index++)
+		{
+			if (childDelta[index] < phi)
+			{
+				secondDelta = phi;
+				phi = childDelta[index];
+				best = index;
+			}
+			else if (childDelta[index] < secondDelta)
+				secondDelta = childDelta[index];
+			delta = AddNumbers(delta, childPhi[index]);
+		}
+
+		if (phi >= thresholdPhi || delta >= thresholdDelta)
+			break;
+		if (m_MaxNodes != 0 && m_Nodes >= m_MaxNodes)
+			break;
+
+		/*
+		Search the child until it stops being the most proving one (its delta passes the second smallest),
+		or this board passes its thresholds (the child's phi is part of the sum of this board's delta).
+		*/
+		U32 childThresholdPhi = thresholdDelta - delta + childPhi[best];
+		U32 childThresholdDelta = (thresholdPhi < secondDelta + 1) ? thresholdPhi : secondDelta + 1;
+		Search(board.DoMoveUnchecked(moves.moves[best]), childThresholdPhi, childThresholdDelta, childPhi[best], childDelta[best]);
+	}
+
+	Store(GetKey(board), phi, delta, m_Nodes - startNodes);
+}
+
+void ProofNumberSolver::GetNumbers(const Bitboard &board, U32 &phi, U32 &delta)
+{
+	if (Evaluate(board, phi, delta))
+		return;
+	if (Probe(GetKey(board), phi, delta))
+		return;
+
+	// Not searched yet. The other player has to refute every move, so delta starts at the number of moves
+	phi = 1;
+	delta = board.GetClearBitsCount();
+}
+
+bool ProofNumberSolver::Evaluate(const Bitboard &board, U32 &phi, U32 &delta) const
+{
+	/*
+	The goal of the player to move is the attacker's goal if it's the attacker (winning),
+	and the opposite if it's the defender (a draw or a win).
+	*/
+	GameTag player = board.GetPlayerTag();
+	GameTag winner = board.GetWinner();
+
+	bool isReached;
+	if (winner == GameTag::Result_Draw)
+		isReached = (player != m_Attacker);
+	else if (winner != GameTag::Result_None)
+		isReached = false;								// The other player won with the last move
+	else if (board.GetWinningSquares(player))
+		isReached = true;								// Wins with this move, either goal is reached
+	else
+	{
+		// Two wins of the other player can't both be blocked
+		U16 otherWins = board.GetWinningSquares(board.GetOtherPlayerTag());
+		if ((otherWins & (otherWins - 1)) == 0)
+			return false;
+		isReached = false;
+	}
+
+	phi = isReached ? 0 : PN_INFINITY;
+	delta = isReached ? PN_INFINITY : 0;
+	return true;
+}
+
+U16 ProofNumberSolver::FindSolvedMove(const Bitboard &board)
+{
+	/*
+	The board was solved for its player, so one child was solved against the player to move there.
+	The table usually still holds it. If it was replaced, searching the children again finds it.
+	*/
+	MoveList moves;
+	board.GetAvailableMoves(moves);
+	for (int pass = 0; pass < 2; pass++)
+		for (int index = 0; index < moves.count; index++)
+		{
+			Bitboard child = board.DoMoveUnchecked(moves.moves[index]);
+
+			U32 phi, delta;
+			GetNumbers(child, phi, delta);
+			if (pass == 1 && delta != 0 && phi != 0)
+				Search(child, PN_INFINITY, PN_INFINITY, phi, delta);
+			if (delta == 0)
+				return moves.moves[index];
+		}
+	return moves.moves[0];
+}
+
+U64 ProofNumberSolver::GetKey(const Bitboard &board) const
+{
+	// The board is unique, no hashing needed: x board | o board | player to move | attacker
+	int transform;
+	Bitboard canonical = board.GetCanonical(transform);
+	return (U64)canonical.GetXBoard() | (U64)canonical.GetOBoard() << 16 |
+		(U64)canonical.GetPlayerTag() << 32 | (U64)m_Attacker << 34;
+}
+
+bool ProofNumberSolver::Probe(U64 key, U32 &phi, U32 &delta) const
+{
+	/* Every key has a bucket of two slots, the first keeps the biggest search, the second the newest */
+	size_t bucket = (size_t)((key * 0x9E3779B97F4A7C15ULL) >> (64 - m_SizeLog2)) & ~(size_t)1;
+	for (size_t index = bucket; index < bucket + 2; index++)
+		if (m_Slots[index].key == key)
+		{
+			phi = m_Slots[index].phi;
+			delta = m_Slots[index].delta;
+			return true;
+		}
+	return false;
+}
+
+void ProofNumberSolver::Store(U64 key, U32 phi, U32 delta, U64 work)
+{
+	size_t bucket = (size_t)((key * 0x9E3779B97F4A7C15ULL) >> (64 - m_SizeLog2)) & ~(size_t)1;
+	Slot *slots = &m_Slots[bucket];
+	Slot entry = { key, phi, delta, work };
+
+	if (slots[0].key == key)
+	{
+		// Numbers of a board only get more exact, the work adds up
+		entry.work += slots[0].work;
+		slots[0] = entry;
+	}
+	else if (work >= slots[0].work)
+	{
+		slots[1] = slots[0];		// Also drops an older entry of the key in the second slot
+		slots[0] = entry;
+	}
+	else
+		slots[1] = entry;
+}
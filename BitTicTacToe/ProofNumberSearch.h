@@ -0,0 +1,100 @@
+#pragma once
+#include "Bitboard.h"
+#include "Tablebase.h"		// TablebaseResult
+#include <memory>
+
+/* The outcome of solving a position, see ProofNumberSolver::SolvePosition. */
+struct ProofResult
+{
+	TablebaseResult result;		// For the player to move, Unknown if the node limit was reached
+	U16 move;					// A move that keeps the result (any move for a loss), 0 if the game is over
+	U64 nodes;					// Boards expanded by both proofs, the size of the proof
+	double milliseconds;
+
+	ProofResult() : result(TablebaseResult::Unknown), move(0), nodes(0), milliseconds(0) {}
+};
+
+/*
+PROOF-NUMBER SEARCH (depth-first, df-pn)
+
+	Proves or disproves a goal of one player (the attacker): that it wins the game.
+	Every board has a proof number, the least number of unsolved boards that must be proved
+	to prove the goal, and a disproof number, the same for disproving it. Unexpanded boards have 1 and 1.
+	The search always expands the most proving board, the one that decides the goal with the least work,
+	so it follows the forcing lines and stays away from wide, undecided parts of the tree.
+
+	Numbers are kept from the view of the player to move (phi and delta):
+		phi(board)   = min delta(child)		the player to move needs one good move
+		delta(board) = sum phi(child)		and the other player has to refute all of them
+	A board is solved when one of them reaches 0. The depth-first version keeps no tree,
+	it searches a child until its numbers pass thresholds derived from its siblings,
+	and keeps the numbers of searched boards in a bounded table, so memory doesn't grow with the search.
+
+	A game has three results, so a position takes up to two proofs:
+	first that the player to move wins, and if not, whether the other player does.
+	Neither proof succeeding means a draw.
+*/
+class ProofNumberSolver
+{
+public:
+
+	/* Create a solver with a table of 2^sizeLog2 slots of 24 bytes. Memory is allocated on first use. */
+	ProofNumberSolver(int sizeLog2 = 18) : m_SizeLog2(sizeLog2), m_Attacker(GameTag::Player_X), m_Nodes(0), m_MaxNodes(0) {}
+
+	/* Copying a solver copies its configuration only, the table is not duplicated. */
+	ProofNumberSolver(const ProofNumberSolver &other) : ProofNumberSolver(other.m_SizeLog2) {}
+	ProofNumberSolver &operator=(const ProofNumberSolver &other);
+
+	~ProofNumberSolver() {}
+
+	/*
+	Solve a position for the player to move. Stops with an Unknown result after expanding maxNodes boards,
+	0 for no limit. The table is kept between calls, so solving positions of the same game gets cheaper.
+	*/
+	ProofResult SolvePosition(const Bitboard &board, U64 maxNodes = 0);
+
+	/* Remove all stored numbers. */
+	void Clear();
+
+private:
+
+	/* A table slot, keyed on the canonical board (exact, not a hash) */
+	struct Slot
+	{
+		U64 key;
+		U32 phi;
+		U32 delta;
+		U64 work;		// Boards expanded to reach these numbers, bigger searches are kept first
+	};
+
+	/* Runs one proof of the attacker's goal from a board, returns the phi of the board. */
+	U32 Prove(const Bitboard &board, GameTag attacker);
+
+	/* The recursive search, expands the board until its phi or delta reach the thresholds. */
+	void Search(const Bitboard &board, U32 thresholdPhi, U32 thresholdDelta, U32 &phi, U32 &delta);
+
+	/* Returns the numbers of a board, from the game result, the table or as an unexpanded board. */
+	void GetNumbers(const Bitboard &board, U32 &phi, U32 &delta);
+
+	/* Sets the numbers of a board whose result is known without a search, returns false otherwise. */
+	bool Evaluate(const Bitboard &board, U32 &phi, U32 &delta) const;
+
+	/* Returns a move of a solved board to a child solved the other way, one that keeps the result. */
+	U16 FindSolvedMove(const Bitboard &board);
+
+	bool Probe(U64 key, U32 &phi, U32 &delta) const;
+	void Store(U64 key, U32 phi, U32 delta, U64 work);
+
+	/* Returns the key of a board for the current attacker, symmetric boards share it. */
+	U64 GetKey(const Bitboard &board) const;
+
+	std::unique_ptr<Slot[]> m_Slots;
+	int m_SizeLog2;
+
+	// The player whose win is being proved
+	GameTag m_Attacker;
+
+	// Boards expanded by the current call, and the limit (0 for none)
+	U64 m_Nodes;
+	U64 m_MaxNodes;
+};
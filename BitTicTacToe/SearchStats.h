@@ -0,0 +1,74 @@
+#pragma once
+#include "Bitboard.h"
+#include <math.h>
+
+/*
+Counters of a minimax search. Every search thread counts into its own copy without atomics,
+and the copies are added up when the search is done, so the numbers are exact with any number of threads.
+*/
+struct SearchStats
+{
+	U64 nodes;					// Boards visited by the search, leaves included
+	U64 leaves;					// Boards at the search depth or where the game ended
+	U64 staticEvaluations;		// Calls to GetStaticValue
+	U64 quiescenceNodes;		// Boards visited by the quiescence search, past the search depth
+	U64 tableProbes;			// Transposition table lookups
+	U64 tableHits;				// Lookups that found the board
+	U64 tableCutoffs;			// Hits whose stored value ended the search of the board
+	U64 cutoffs[16];			// Beta cutoffs by the index of the move that caused them, 0 is the first move searched
+	U64 endgameSolves;			// Boards handed to the endgame solver
+	U64 endgameNodes;			// Boards visited by the endgame solver
+	int maxPly;					// The deepest board reached, in moves from the root, quiescence included
+
+	// Set for the whole move once the counters of all threads are added up
+	int depth;					// Depth of the deepest completed iteration
+	double milliseconds;
+
+	SearchStats() { Clear(); }
+
+	void Clear()
+	{
+		nodes = leaves = staticEvaluations = quiescenceNodes = 0;
+		tableProbes = tableHits = tableCutoffs = 0;
+		endgameSolves = endgameNodes = 0;
+		for (int index = 0; index < 16; index++)
+			cutoffs[index] = 0;
+		maxPly = depth = 0;
+		milliseconds = 0;
+	}
+
+	/* Add the counters of another thread. */
+	void Add(const SearchStats &other)
+	{
+		nodes += other.nodes;
+		leaves += other.leaves;
+		staticEvaluations += other.staticEvaluations;
+		quiescenceNodes += other.quiescenceNodes;
+		tableProbes += other.tableProbes;
+		tableHits += other.tableHits;
+		tableCutoffs += other.tableCutoffs;
+		endgameSolves += other.endgameSolves;
+		endgameNodes += other.endgameNodes;
+		for (int index = 0; index < 16; index++)
+			cutoffs[index] += other.cutoffs[index];
+		if (other.maxPly > maxPly)
+			maxPly = other.maxPly;
+	}
+
+	/* Returns the number of beta cutoffs, by any move. */
+	U64 GetCutoffs() const
+	{
+		U64 total = 0;
+		for (int index = 0; index < 16; index++)
+			total += cutoffs[index];
+		return total;
+	}
+
+	double GetNodesPerSecond() const { return (milliseconds > 0) ? (nodes + quiescenceNodes + endgameNodes) * 1000.0 / milliseconds : 0; }
+
+	/*
+	Returns the effective branching factor, the number of moves per board a uniform tree of the same
+	depth and size would have: nodes^(1/depth). Nodes of all iterative deepening iterations are counted.
+	*/
+	double GetBranchingFactor() const { return (depth > 0 && nodes > 0) ? pow((double)nodes, 1.0 / depth) : 0; }
+};
@@ -0,0 +1,110 @@
+#pragma once
+#include "Bitboard.h"
+#include <atomic>
+#include <chrono>
+#include <limits>
+
+/*
+Stops a search when its deadline passes or another thread asks it to, shared by all worker threads of a move.
+Also holds the best move found so far, for other threads to read while the search runs.
+
+Searches started by GetMoveAsync are numbered before their thread starts (Reserve), so a request stopped before
+its search began still stops it, and a late stop of an earlier request doesn't stop a later search.
+The deadline is kept as an atomic count of clock ticks, so it may be set from one thread while the workers check it.
+Copies of a player start without a deadline, so players stay copyable.
+*/
+class SearchStop
+{
+public:
+
+	typedef std::chrono::steady_clock Clock;
+
+	SearchStop() : m_bStopped(false), m_Deadline(NO_DEADLINE), m_BestMove(0), m_LastRequest(0), m_Reserved(0), m_Current(0), m_StoppedRequest(0) {}
+	SearchStop(const SearchStop &) : SearchStop() {}
+	SearchStop &operator=(const SearchStop &) { return *this; }
+
+	/* Number the next search started with Begin for a request, and return its number. Called before the search thread starts. */
+	unsigned Reserve()
+	{
+		unsigned request = ++m_LastRequest;
+		m_Reserved = request;
+		return request;
+	}
+
+	/*
+	Start the search of a move: without a deadline, without a best move,
+	stopped at once if its request was stopped already. Searches that weren't reserved get a new number.
+	*/
+	void Begin()
+	{
+		unsigned request = m_Reserved.exchange(0);
+		if (request == 0)
+			request = ++m_LastRequest;
+
+		// In this order, a StopRequest that doesn't see the new number is seen by the check below
+		m_Deadline = NO_DEADLINE;
+		m_BestMove = 0;
+		m_bStopped = false;
+		m_Current = request;
+		if (m_StoppedRequest == request)
+			m_bStopped = true;
+	}
+
+	/* Stop the search of a request, whether it's running or not started yet, from any thread. */
+	void StopRequest(unsigned request)
+	{
+		m_StoppedRequest = request;
+		if (m_Current == request)
+			m_bStopped = true;
+	}
+
+	/* Stop the search once the given number of milliseconds from now have passed. Keeps an earlier Stop. */
+	void SetDeadline(int milliseconds) { SetDeadline(Clock::now() + std::chrono::milliseconds(milliseconds)); }
+
+	/* Stop the search once the clock reaches the deadline. Keeps an earlier Stop. */
+	void SetDeadline(Clock::time_point deadline) { m_Deadline = deadline.time_since_epoch().count(); }
+
+	/* Stop the search now, from any thread. */
+	void Stop() { m_bStopped = true; }
+
+	/* Remove the deadline and the stop, for searches that are not a move (pondering). Requests no longer stop them. */
+	void Clear()
+	{
+		m_Deadline = NO_DEADLINE;
+		m_bStopped = false;
+		m_Current = 0;
+	}
+
+	/* Returns true if the search should stop, checking the clock when there is a deadline. */
+	inline bool CheckDeadline()
+	{
+		if (m_bStopped.load(std::memory_order_relaxed))
+			return true;
+		Clock::rep deadline = m_Deadline.load(std::memory_order_relaxed);
+		if (deadline == NO_DEADLINE)
+			return false;
+		if (Clock::now().time_since_epoch().count() >= deadline)
+			m_bStopped = true;
+		return m_bStopped;
+	}
+
+	/* Returns true if the deadline was reached or Stop was called, results of the interrupted search are incomplete. */
+	inline bool IsStopped() const { return m_bStopped.load(std::memory_order_relaxed); }
+
+	/* The best move of the search so far, 0 before one is known. Thread safe. */
+	void SetBestMove(U16 move) { m_BestMove.store(move, std::memory_order_relaxed); }
+	U16 GetBestMove() const { return m_BestMove.load(std::memory_order_relaxed); }
+
+private:
+
+	static const Clock::rep NO_DEADLINE = std::numeric_limits<Clock::rep>::max();
+
+	std::atomic<bool> m_bStopped;
+	std::atomic<Clock::rep> m_Deadline;			// Clock ticks since the clock's epoch, NO_DEADLINE if none
+	std::atomic<U16> m_BestMove;
+
+	std::atomic<unsigned> m_LastRequest;		// Number of the last search numbered, requests start at 1
+	std::atomic<unsigned> m_Reserved;			// Number reserved for the next Begin, 0 if none
+	std::atomic<unsigned> m_Current;			// Number of the running search, 0 between moves and while pondering
+	std::atomic<unsigned> m_StoppedRequest;		// Number of the last request stopped
+};
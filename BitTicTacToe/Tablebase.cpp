@@ -0,0 +1,321 @@
+#include "Tablebase.h"
+#include <stdio.h>
+#include <string.h>		// memcmp
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/* File layout: magic (4 bytes) | number of entries (4 bytes) | entries */
+static const char TABLEBASE_MAGIC[4] = { 'B', 'T', 'T', 'B' };
+static const size_t TABLEBASE_HEADER_SIZE = 8;
+
+/* Entry layout: result (2 bits) | distance (6 bits) */
+static inline U8 EncodeEntry(TablebaseResult result, int distance)
+{
+	return (U8)((int)result << 6 | distance);
+}
+
+static inline TablebaseResult GetEntryResult(U8 entry) { return (TablebaseResult)(entry >> 6); }
+static inline int GetEntryDistance(U8 entry) { return entry & 0x3F; }
+
+/* The tables of the position index, see the Tablebase description */
+struct PositionIndex
+{
+	U16 ranks[65536];			// Position of every mask among the masks with as many set bits, in increasing order
+	U32 layerOffsets[17];		// Index of the first position with n occupied squares
+	U32 splits[17];				// Ways to split n occupied squares, C(n, n / 2)
+
+	PositionIndex()
+	{
+		U32 counts[17] = { 0 };
+		for (int mask = 0; mask < 65536; mask++)
+			ranks[mask] = (U16)counts[CountBitsU16((U16)mask)]++;
+
+		// counts[n] is now C(16, n), and C(n, k) is the number of n bit masks with k set bits
+		U32 offset = 0;
+		for (int setBits = 0; setBits <= 16; setBits++)
+		{
+			splits[setBits] = 0;
+			for (int mask = 0; mask < (1 << setBits); mask++)
+				if (CountBitsU16((U16)mask) == setBits / 2)
+					splits[setBits]++;
+
+			layerOffsets[setBits] = offset;
+			offset += counts[setBits] * splits[setBits];
+		}
+	}
+};
+
+static const PositionIndex positionIndex;
+
+U32 Tablebase::GetIndex(U16 moverBoard, U16 otherBoard)
+{
+	U16 occupied = moverBoard | otherBoard;
+	int setBits = CountBitsU16(occupied);
+
+	/* The split: which of the occupied squares are the mover's, as a mask of setBits bits */
+	U16 split = 0;
+	int bit = 0;
+	for (U16 squares = occupied; squares; bit++)
+		if (Bitboard::PopMove(squares) & moverBoard)
+			split |= 1 << bit;
+
+	return positionIndex.layerOffsets[setBits] +
+		positionIndex.ranks[occupied] * positionIndex.splits[setBits] + positionIndex.ranks[split];
+}
+
+/* Solves one position, all positions with one more set bit must be solved already. */
+static void SolvePosition(U8 *table, U16 mover, U16 other)
+{
+	// The player to move can't have a win pattern, the game would have ended on its last move
+	if (Bitboard::HasWinPattern(mover))
+		return;
+
+	U8 &entry = table[Tablebase::GetIndex(mover, other)];
+
+	// The other player completed a line with the last move
+	if (Bitboard::HasWinPattern(other))
+	{
+		entry = EncodeEntry(TablebaseResult::Loss, 0);
+		return;
+	}
+
+	U16 moves = (U16)~(mover | other);
+	if (!moves)
+	{
+		entry = EncodeEntry(TablebaseResult::Draw, 0);
+		return;
+	}
+
+	/* Pick the best move: the fastest win, otherwise a draw, otherwise the slowest loss */
+	TablebaseResult bestResult = TablebaseResult::Loss;
+	int bestDistance = 0;
+
+	while (moves)
+	{
+		U16 move = Bitboard::PopMove(moves);
+
+		// After the move, the players swap roles
+		U8 child = table[Tablebase::GetIndex(other, mover | move)];
+		int distance = GetEntryDistance(child) + 1;
+
+		switch (GetEntryResult(child))
+		{
+		case TablebaseResult::Loss:
+			if (bestResult != TablebaseResult::Win || distance < bestDistance)
+			{
+				bestResult = TablebaseResult::Win;
+				bestDistance = distance;
+			}
+			break;
+		case TablebaseResult::Draw:
+			if (bestResult == TablebaseResult::Loss)
+			{
+				bestResult = TablebaseResult::Draw;
+				bestDistance = 0;
+			}
+			break;
+		case TablebaseResult::Win:
+			if (bestResult == TablebaseResult::Loss && distance > bestDistance)
+				bestDistance = distance;
+			break;
+		default:
+			break;
+		}
+	}
+
+	entry = EncodeEntry(bestResult, bestDistance);
+}
+
+void Tablebase::SolveLayer(U8 *table, int setBits, int numberOfThreads)
+{
+	// Every occupied squares mask with the given number of set bits
+	vector<U16> masks;
+	for (int mask = 0; mask < 65536; mask++)
+		if ((int)bitset<16>(mask).count() == setBits)
+			masks.push_back((U16)mask);
+
+	// The player to move has made half of the moves, rounded down
+	int moverBits = setBits / 2;
+
+	// Positions of one layer only depend on the previous layer, so threads share masks freely
+	atomic<size_t> nextMask(0);
+	auto worker = [&]()
+	{
+		for (size_t index = nextMask++; index < masks.size(); index = nextMask++)
+		{
+			U16 mask = masks[index];
+
+			// Split the mask between the players in every possible way
+			for (U16 mover = mask; ; mover = (mover - 1) & mask)
+			{
+				if ((int)bitset<16>(mover).count() == moverBits)
+					SolvePosition(table, mover, mask ^ mover);
+				if (mover == 0)
+					break;
+			}
+		}
+	};
+
+	vector<future<void>> futures;
+	for (int thread = 1; thread < numberOfThreads; thread++)
+		futures.push_back(async(launch::async, worker));
+	worker();
+	for (future<void> &f : futures)
+		f.get();
+}
+
+bool Tablebase::Generate(const char *filename, int numberOfThreads, bool verbose)
+{
+	if (numberOfThreads < 1)
+		numberOfThreads = 1;
+
+	auto start = chrono::high_resolution_clock::now();
+
+	/* Retrograde analysis: solve from full boards back to the empty board */
+	vector<U8> table(TABLE_SIZE, 0);
+	for (int setBits = 16; setBits >= 0; setBits--)
+	{
+		SolveLayer(table.data(), setBits, numberOfThreads);
+		if (verbose) printf("\rSolving tablebase: %i/17 layers done", 17 - setBits);
+	}
+
+	chrono::duration<float, milli> elapsed = chrono::high_resolution_clock::now() - start;
+	if (verbose)
+	{
+		U8 root = table[GetIndex(0, 0)];
+		const char *results[] = { "unknown", "win", "draw", "loss" };
+		printf("\nSolved in %f ms. Empty board: %s for the first player.\n", elapsed.count(), results[(int)GetEntryResult(root)]);
+	}
+
+	ofstream out(filename, ios::binary);
+	if (!out.is_open())
+	{
+		printf("Unable to save tablebase.\n");
+		return false;
+	}
+
+	U32 size = TABLE_SIZE;
+	out.write(TABLEBASE_MAGIC, sizeof(TABLEBASE_MAGIC));
+	out.write(reinterpret_cast<char *>(&size), sizeof(U32));
+	out.write(reinterpret_cast<char *>(table.data()), TABLE_SIZE);
+	return out.good();
+}
+
+bool Tablebase::Open(const char *filename)
+{
+	Close();
+	size_t size = TABLEBASE_HEADER_SIZE + TABLE_SIZE;
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || (size_t)fileSize.QuadPart != size)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (mapping == NULL)
+		return false;
+
+	// The view keeps the mapping alive after its handle is closed
+	void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (view == NULL)
+		return false;
+#else
+	int file = open(filename, O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat fileStat;
+	if (fstat(file, &fileStat) != 0 || (size_t)fileStat.st_size != size)
+	{
+		close(file);
+		return false;
+	}
+
+	void *view = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+	close(file);
+	if (view == MAP_FAILED)
+		return false;
+#endif
+
+	m_Mapping = view;
+	m_MappingSize = size;
+
+	// Check the header before using the entries
+	const char *header = static_cast<const char *>(view);
+	U32 entries;
+	memcpy(&entries, header + sizeof(TABLEBASE_MAGIC), sizeof(U32));
+	if (memcmp(header, TABLEBASE_MAGIC, sizeof(TABLEBASE_MAGIC)) != 0 || entries != TABLE_SIZE)
+	{
+		Close();
+		return false;
+	}
+
+	m_Entries = reinterpret_cast<const U8 *>(header + TABLEBASE_HEADER_SIZE);
+	return true;
+}
+
+void Tablebase::Close()
+{
+	if (m_Mapping)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_Mapping);
+#else
+		munmap(m_Mapping, m_MappingSize);
+#endif
+	}
+	m_Mapping = nullptr;
+	m_MappingSize = 0;
+	m_Entries = nullptr;
+}
+
+U8 Tablebase::Probe(const Bitboard &board) const
+{
+	if (!m_Entries)
+		return 0;
+
+	U16 mover = (board.GetPlayerTag() == GameTag::Player_X) ? board.GetXBoard() : board.GetOBoard();
+	U16 other = (board.GetPlayerTag() == GameTag::Player_X) ? board.GetOBoard() : board.GetXBoard();
+
+	// Boards where the player to move made more moves than the other player aren't stored
+	if (CountBitsU16(mover) != CountBitsU16(mover | other) / 2)
+		return 0;
+
+	return m_Entries[GetIndex(mover, other)];
+}
+
+TablebaseResult Tablebase::GetResult(const Bitboard &board) const
+{
+	return GetEntryResult(Probe(board));
+}
+
+int Tablebase::GetDistance(const Bitboard &board) const
+{
+	return GetEntryDistance(Probe(board));
+}
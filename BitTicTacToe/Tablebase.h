@@ -0,0 +1,80 @@
+#pragma once
+#include "Bitboard.h"
+#include <cstddef>		// size_t
+
+/* The game-theoretic result of a position, for the player to move. */
+enum class TablebaseResult
+{
+	Unknown,	// Not in the table (unreachable position, or no table loaded)
+	Win,
+	Draw,
+	Loss
+};
+
+/*
+A complete solution of the 4x4 game, generated by retrograde analysis.
+
+Only boards where the player to move made half of the moves (rounded down) are stored, the others
+can't be reached. They are numbered densely, grouped by the number of occupied squares:
+	layer offset + rank of the occupied squares * number of splits + rank of the split between the players
+where a rank is the position of a mask among all masks with as many set bits, in increasing order.
+That's 10,165,779 positions instead of the 3^16 a base-3 index would take.
+Every position has one byte: the result in the 2 high bits,
+and the number of moves until the game ends in the low 6 bits (0 for draws).
+
+Symmetric boards are not merged: numbering only canonical boards densely needs a table of them
+about the size of the savings, or a search per probe, while this index is a few lookups.
+
+Since positions are stored relative to the player to move, the same table serves
+both X and O, whoever started the game.
+The file is memory-mapped, so opening it costs nothing and probing is a single load.
+*/
+class Tablebase
+{
+public:
+
+	Tablebase() : m_Entries(nullptr), m_Mapping(nullptr), m_MappingSize(0) {}
+
+	~Tablebase() { Close(); }
+
+	Tablebase(const Tablebase &) = delete;
+	Tablebase &operator=(const Tablebase &) = delete;
+
+	/* Solve all positions with the given number of threads and save the table to a file. */
+	static bool Generate(const char *filename, int numberOfThreads = 4, bool verbose = true);
+
+	/* Memory-map a tablebase file. Returns false if it doesn't exist or isn't valid. */
+	bool Open(const char *filename);
+
+	/* Unmap the file. */
+	void Close();
+
+	inline bool IsOpen() const { return m_Entries != nullptr; }
+
+	/* Returns the result of a board for the player who is next to make a move. */
+	TablebaseResult GetResult(const Bitboard &board) const;
+
+	/* Returns the number of moves until the game ends with perfect play (0 for draws). */
+	int GetDistance(const Bitboard &board) const;
+
+	/* Returns the index of a position in the table, the player to move must have made half of the moves (rounded down). */
+	static U32 GetIndex(U16 moverBoard, U16 otherBoard);
+
+	/* Number of entries, the sum of C(16, n) * C(n, n / 2) over the numbers of occupied squares n */
+	static const U32 TABLE_SIZE = 10165779;
+
+private:
+
+	/* Returns the entry of a board */
+	U8 Probe(const Bitboard &board) const;
+
+	/* Solve all positions with the given number of set bits, used by Generate. */
+	static void SolveLayer(U8 *table, int setBits, int numberOfThreads);
+
+	/* The entries inside the mapped file (after the header). */
+	const U8 *m_Entries;
+
+	/* Platform-specific mapping handles */
+	void *m_Mapping;
+	size_t m_MappingSize;
+};
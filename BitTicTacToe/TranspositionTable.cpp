@@ -0,0 +1,170 @@
+#include "TranspositionTable.h"
+#include <random>
+
+/*
+Zobrist keys, one random number for every (player, square) pair plus one for the player to move.
+Keys of squares are combined per byte of the board in advance,
+so hashing a board takes four lookups instead of a loop over the set bits.
+*/
+struct ZobristKeys
+{
+	U64 xBytes[2][256];
+	U64 oBytes[2][256];
+	U64 oToMove;
+
+	ZobristKeys()
+	{
+		std::mt19937_64 generator(0x4269CA3D5B7E11F1ULL);	// Fixed seed, hashes are the same on every run
+
+		U64 xSquares[16], oSquares[16];
+		for (int square = 0; square < 16; square++)
+		{
+			xSquares[square] = generator();
+			oSquares[square] = generator();
+		}
+		oToMove = generator();
+
+		for (int half = 0; half < 2; half++)
+			for (int byte = 0; byte < 256; byte++)
+			{
+				xBytes[half][byte] = 0;
+				oBytes[half][byte] = 0;
+				for (int bit = 0; bit < 8; bit++)
+					if (byte & (1 << bit))
+					{
+						xBytes[half][byte] ^= xSquares[half * 8 + bit];
+						oBytes[half][byte] ^= oSquares[half * 8 + bit];
+					}
+			}
+	}
+};
+
+static const ZobristKeys zobrist;
+
+U64 TranspositionTable::HashBoard(const Bitboard &board)
+{
+	U16 x = board.GetXBoard();
+	U16 o = board.GetOBoard();
+
+	U64 key =
+		zobrist.xBytes[0][x & 0xFF] ^ zobrist.xBytes[1][x >> 8] ^
+		zobrist.oBytes[0][o & 0xFF] ^ zobrist.oBytes[1][o >> 8];
+
+	if (board.GetPlayerTag() == GameTag::Player_O)
+		key ^= zobrist.oToMove;
+
+	return key;
+}
+
+TranspositionTable &TranspositionTable::operator=(const TranspositionTable &other)
+{
+	if (this != &other)
+	{
+		// Only the configuration is copied, see the class description
+		m_SizeLog2 = other.m_SizeLog2;
+		m_Policy = other.m_Policy;
+		m_Age = 0;
+		m_GameAge = 0;
+		m_Slots.reset();
+	}
+	return *this;
+}
+
+void TranspositionTable::NewSearch()
+{
+	if (!m_Slots)
+	{
+		m_Slots.reset(new Slot[(size_t)1 << m_SizeLog2]);
+		Clear();
+	}
+	m_Age++;
+
+	// The ages of the game would cover every age, and entries of earlier games look new again
+	if ((U8)(m_Age - m_GameAge) == 0xFF)
+	{
+		Clear();
+		m_GameAge = m_Age;
+	}
+}
+
+void TranspositionTable::NewGame()
+{
+	// The next search gets this age
+	m_GameAge = m_Age + 1;
+}
+
+void TranspositionTable::Clear()
+{
+	if (!m_Slots)
+		return;
+
+	size_t size = (size_t)1 << m_SizeLog2;
+	for (size_t index = 0; index < size; index++)
+	{
+		m_Slots[index].check.store(0, std::memory_order_relaxed);
+		m_Slots[index].data.store(0, std::memory_order_relaxed);
+	}
+}
+
+U64 TranspositionTable::PackData(int value, U16 move, int depth, TTBound bound, U8 age)
+{
+	if (depth > 0x3F) depth = 0x3F;		// 6 bits are plenty for a 16 square board
+
+	return
+		(U64)(U32)value					|
+		(U64)move				<< 32	|
+		(U64)depth				<< 48	|
+		(U64)bound				<< 54	|
+		(U64)age				<< 56;
+}
+
+void TranspositionTable::UnpackData(U64 data, TTEntry &entry)
+{
+	entry.value = (int)(U32)(data & 0xFFFFFFFF);
+	entry.move  = (U16)(data >> 32);
+	entry.depth = GetDataDepth(data);
+	entry.bound = (TTBound)((data >> 54) & 0x3);
+}
+
+bool TranspositionTable::Probe(U64 key, TTEntry &entry) const
+{
+	const Slot &slot = m_Slots[key & (((U64)1 << m_SizeLog2) - 1)];
+
+	U64 data  = slot.data.load(std::memory_order_relaxed);
+	U64 check = slot.check.load(std::memory_order_relaxed);
+
+	// Empty slots, other positions and torn writes all fail this check
+	if ((check ^ data) != key || data == 0)
+		return false;
+
+	// Entries of previous games are ignored, which clears the table in O(1)
+	if ((U8)(m_Age - GetDataAge(data)) > (U8)(m_Age - m_GameAge))
+		return false;
+
+	UnpackData(data, entry);
+	return true;
+}
+
+void TranspositionTable::Store(U64 key, int value, int depth, TTBound bound, U16 move)
+{
+	Slot &slot = m_Slots[key & (((U64)1 << m_SizeLog2) - 1)];
+
+	if (m_Policy == TTReplacement::DepthPreferred)
+	{
+		U64 oldData = slot.data.load(std::memory_order_relaxed);
+		U64 oldKey  = slot.check.load(std::memory_order_relaxed) ^ oldData;
+
+		// Keep a deeper result of another position if it belongs to the current search
+		if (oldData != 0 && oldKey != key &&
+			GetDataAge(oldData) == m_Age && GetDataDepth(oldData) > depth)
+			return;
+
+		// Don't lose the best move of a position when storing a result without one
+		if (move == 0 && oldKey == key)
+			move = (U16)(oldData >> 32);
+	}
+
+	U64 data = PackData(value, move, depth, bound, m_Age);
+	slot.check.store(key ^ data, std::memory_order_relaxed);
+	slot.data.store(data, std::memory_order_relaxed);
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include "Bitboard.h"
+#include <atomic>
+#include <memory>
+
+/* The kind of bound a stored search value represents. */
+enum class TTBound
+{
+	None,
+	Exact,		// The value is the exact minimax value
+	Lower,		// The search failed high, the real value is at least this
+	Upper		// The search failed low, the real value is at most this
+};
+
+/* Decides whether a new entry may overwrite the one already in its slot. */
+enum class TTReplacement
+{
+	Always,				// Always keep the newest entry
+	DepthPreferred		// Keep deeper entries of the current search
+};
+
+/* A decoded transposition table entry. */
+struct TTEntry
+{
+	int		value;
+	U16		move;
+	int		depth;
+	TTBound bound;
+};
+
+/*
+A fixed-size, memory-bounded cache of search results keyed on Zobrist hashes of boards.
+
+Every slot stores the key xor'ed with the data next to the data itself (lockless hashing),
+so worker threads may probe and store concurrently without locks:
+a slot torn by two simultaneous writes simply fails the key check and is treated as a miss.
+
+Entries are kept for the whole game, later searches probe the results of earlier ones.
+Every entry has the age of the search that stored it: entries of the current search are preferred
+when slots are replaced, and entries older than the current game are ignored.
+
+Copying a table copies its configuration only, the cached results are not duplicated.
+*/
+class TranspositionTable
+{
+public:
+
+	/* Create a table with 2^sizeLog2 slots. Memory is allocated on first use. */
+	TranspositionTable(int sizeLog2 = 18, TTReplacement policy = TTReplacement::DepthPreferred) :
+		m_SizeLog2(sizeLog2),
+		m_Policy(policy),
+		m_Age(0),
+		m_GameAge(0) {}
+
+	TranspositionTable(const TranspositionTable &other) :
+		m_SizeLog2(other.m_SizeLog2),
+		m_Policy(other.m_Policy),
+		m_Age(0),
+		m_GameAge(0) {}
+
+	TranspositionTable &operator=(const TranspositionTable &other);
+
+	~TranspositionTable() {}
+
+	/* Allocate the slots if needed and start a new search, entries of older searches of the game stay valid.
+	Not thread safe, call before searching. */
+	void NewSearch();
+
+	/* Start a new game, entries of all earlier searches become invalid. Not thread safe. */
+	void NewGame();
+
+	/* Remove all stored entries. */
+	void Clear();
+
+	/* Returns true and fills the entry if the key is stored in the table. */
+	bool Probe(U64 key, TTEntry &entry) const;
+
+	/* Store a search result, subject to the replacement policy. */
+	void Store(U64 key, int value, int depth, TTBound bound, U16 move);
+
+	void SetReplacementPolicy(TTReplacement policy) { m_Policy = policy; }
+
+	/* Returns the Zobrist hash of a board (both players' squares and the player to move). */
+	static U64 HashBoard(const Bitboard &board);
+
+private:
+
+	/* A packed entry, the check word is key ^ data. */
+	struct Slot
+	{
+		std::atomic<U64> check;
+		std::atomic<U64> data;
+	};
+
+	/* Pack and unpack the data word: value | move | depth | bound | age */
+	static U64  PackData(int value, U16 move, int depth, TTBound bound, U8 age);
+	static void UnpackData(U64 data, TTEntry &entry);
+	static U8   GetDataAge(U64 data) { return (U8)(data >> 56); }
+	static int  GetDataDepth(U64 data) { return (int)((data >> 48) & 0x3F); }
+
+	std::unique_ptr<Slot[]> m_Slots;
+
+	int m_SizeLog2;
+	TTReplacement m_Policy;
+
+	// Incremented every search, older entries are replaced first
+	U8 m_Age;
+
+	// Age of the first search of the current game, entries older than it are invalid
+	U8 m_GameAge;
+};